@@ -0,0 +1,643 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mc_batch.h"
+#include "mc_estimator.h"
+#include "mc_options.h"
+#include "mc_pool.h"
+#include "mc_rng.h"
+
+#define QUERY_POINTS (64 * BATCH_SIZE)  // query points reused by every polygon kernel
+#define DEFAULT_MIN_TIME 0.2            // seconds each measurement runs at least
+#define DEFAULT_MAX_VERTICES 1000000
+#define SCALING_VERTICES 10000          // polygon of the thread-scaling curve
+#define CHECK_POINTS 4096               // random and mapped points of each self-check polygon
+#define CHECK_LINES 512                 // edges, slab and cell lines probed per polygon
+#define CHECK_SCALE_VERTICES 8192       // larger polygons get proportionally fewer probes (O(n) reference)
+#define CHECK_OFFSET 1e-7               // distance of the near-boundary probes
+#define CHECK_TOLERANCE 1e-9            // closer than this to an edge, a point is on the boundary
+#define MAX_REPORTED 10                 // mismatches printed per polygon
+
+static const int SIZES[] = {3, 10, 100, 1000, 10000, 100000, 1000000};
+
+/*
+ * One measured kernel: run(ctx, reps) performs reps repetitions and returns
+ * the number of operations done (calls, samples or vertices), or -1 if it failed.
+ */
+typedef double (*KernelFn)(void *ctx, long reps);
+
+typedef struct {
+    const char *shape;      // "convex", "concave" or "-"
+    int vertices;
+    int threads;
+} Row;
+
+typedef struct {
+    const PolygonModel *model;
+    const SlabIndex *index;
+    const double *xs;
+    const double *ys;
+    SamplerKind sampler;
+    DomainKind domain;
+    int vertices;
+    bool concave;
+    int threads;
+} Bench;
+
+static volatile long benchSink;     // keeps the compiler from dropping the measured work
+static double minTime = DEFAULT_MIN_TIME;
+
+/**
+ * @brief Seconds on the monotonic clock.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Runs a kernel with a growing number of repetitions until it lasts
+ * minTime, then prints one row: ns per operation and operations per second
+ * per core.
+ */
+static void measure(const char *kernel, const char *variant, const Row *row, KernelFn run, void *ctx) {
+    long reps = 1;
+    for (;;) {
+        double start = now();
+        double ops = run(ctx, reps);
+        double seconds = now() - start;
+
+        if (ops < 0) {
+            fprintf(stderr, "%s (%s, %d vertices) failed\n", kernel, variant, row->vertices);
+            return;
+        }
+        if (seconds >= minTime) {
+            printf("%s\t%s\t%d\t%s\t%d\t%.0f\t%.6f\t%.3f\t%.0f\n", kernel, row->shape, row->vertices, variant,
+                   row->threads, ops, seconds, seconds / ops * 1e9, ops / seconds / row->threads);
+            fflush(stdout);
+            return;
+        }
+        // Estimativa do número de repetições que chega a minTime, com margem
+        double scale = seconds > 0 ? 1.2 * minTime / seconds : 16;
+        reps = scale > 16 ? reps * 16 : scale < 2 ? reps * 2 : (long)(reps * scale);
+    }
+}
+
+static double runOrientation(void *ctx, long reps) {
+    const Bench *b = ctx;
+    long sum = 0;
+    for (long r = 0; r < reps; r++) {
+        for (int i = 0; i + 2 < QUERY_POINTS; i++) {
+            Point p = {b->xs[i], b->ys[i]}, q = {b->xs[i + 1], b->ys[i + 1]}, s = {b->xs[i + 2], b->ys[i + 2]};
+            sum += orientation(p, q, s);
+        }
+    }
+    benchSink += sum;
+    return (double)reps * (QUERY_POINTS - 2);
+}
+
+static double runDoIntersect(void *ctx, long reps) {
+    const Bench *b = ctx;
+    long sum = 0;
+    for (long r = 0; r < reps; r++) {
+        for (int i = 0; i + 3 < QUERY_POINTS; i++) {
+            Point p1 = {b->xs[i], b->ys[i]}, q1 = {b->xs[i + 1], b->ys[i + 1]};
+            Point p2 = {b->xs[i + 2], b->ys[i + 2]}, q2 = {b->xs[i + 3], b->ys[i + 3]};
+            sum += doIntersect(p1, q1, p2, q2);
+        }
+    }
+    benchSink += sum;
+    return (double)reps * (QUERY_POINTS - 3);
+}
+
+static double runSampler(void *ctx, long reps) {
+    const Bench *b = ctx;
+    BoundingBox box = {0, 2, 0, 2};
+    double xs[BATCH_SIZE], ys[BATCH_SIZE];
+    Rng rng;
+    Sampler sampler;
+
+    rngSubstream(&rng, 1, 0);
+    initSampler(&sampler, b->sampler, box, &rng, 1, 0, (uint64_t)reps * BATCH_SIZE);
+    for (long r = 0; r < reps; r++) samplerFill(&sampler, xs, ys, BATCH_SIZE);
+    benchSink += (long)xs[0];
+    return (double)reps * BATCH_SIZE;
+}
+
+/**
+ * @brief The original O(n) crossing-number test, one query at a time.
+ */
+static double runNaive(void *ctx, long reps) {
+    const Bench *b = ctx;
+    long hits = 0;
+    for (long r = 0; r < reps; r++) {
+        Point p = {b->xs[r % QUERY_POINTS], b->ys[r % QUERY_POINTS]};
+        hits += isInsidePolygon(b->model->points, b->model->numPoints, p);
+    }
+    benchSink += hits;
+    return reps;
+}
+
+static double runSlab(void *ctx, long reps) {
+    const Bench *b = ctx;
+    unsigned char inside[BATCH_SIZE];
+    long hits = 0;
+    for (long r = 0; r < reps; r++) {
+        int base = (int)(r % (QUERY_POINTS / BATCH_SIZE)) * BATCH_SIZE;
+        hits += insideSlabBatch(b->index, b->xs + base, b->ys + base, BATCH_SIZE, inside);
+    }
+    benchSink += hits;
+    return (double)reps * BATCH_SIZE;
+}
+
+static double runFan(void *ctx, long reps) {
+    const Bench *b = ctx;
+    unsigned char inside[BATCH_SIZE];
+    long hits = 0;
+    for (long r = 0; r < reps; r++) {
+        int base = (int)(r % (QUERY_POINTS / BATCH_SIZE)) * BATCH_SIZE;
+        hits += insideConvexBatch(&b->model->convex, b->xs + base, b->ys + base, BATCH_SIZE, inside);
+    }
+    benchSink += hits;
+    return (double)reps * BATCH_SIZE;
+}
+
+static double runGrid(void *ctx, long reps) {
+    const Bench *b = ctx;
+    long hits = 0;
+    for (long r = 0; r < reps; r++) {
+        int base = (int)(r % (QUERY_POINTS / BATCH_SIZE)) * BATCH_SIZE;
+        hits += countInsideBatch(&b->model->grid, b->xs + base, b->ys + base, BATCH_SIZE, NULL);
+    }
+    benchSink += hits;
+    return (double)reps * BATCH_SIZE;
+}
+
+/**
+ * @brief End to end: draw, map and test whole chunks, as the workers do.
+ */
+static double runChunk(void *ctx, long reps) {
+    const Bench *b = ctx;
+    EstimatorConfig config;
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.totalPoints = reps * CHUNK_POINTS;
+    config.sampler = b->sampler;
+    config.domain = b->domain;
+
+    long hits = 0;
+    for (long c = 0; c < reps; c++) hits += sampleChunk(b->model, &config, c, NULL, NULL).hits;
+    benchSink += hits;
+    return (double)reps * CHUNK_POINTS;
+}
+
+/**
+ * @brief Generates a polygon of n vertices around (1, 1): a regular polygon,
+ * or a five-petal flower (concave) whose edges stay short as n grows, like
+ * those of a finely digitized outline.
+ * @return malloc'ed vertices.
+ */
+static Point *generatePolygon(int n, bool concave) {
+    Point *points = malloc((size_t)n * sizeof(Point));
+    if (points == NULL) return NULL;
+
+    const double pi = acos(-1.0);
+    for (int i = 0; i < n; i++) {
+        double angle = 2 * pi * i / n;
+        double radius = concave ? 0.8 + 0.2 * cos(5 * angle) : 1.0;
+        points[i] = (Point){1 + radius * cos(angle), 1 + radius * sin(angle)};
+    }
+    return points;
+}
+
+static double runBuild(void *ctx, long reps) {
+    const Bench *b = ctx;
+    for (long r = 0; r < reps; r++) {
+        PolygonModel model;
+        Point *points = generatePolygon(b->vertices, b->concave);
+        if (points == NULL || !buildPolygonModel(points, b->vertices, &model)) return -1;
+        benchSink += model.grid.numBoundaryCells;
+        freePolygonModel(&model);
+    }
+    return (double)reps * b->vertices;
+}
+
+/**
+ * @brief Measures every polygon kernel on one synthetic polygon.
+ */
+static void benchPolygon(int n, bool concave, const double *xs, const double *ys) {
+    Row row = {concave ? "concave" : "convex", n, 1};
+    Bench bench = {.xs = xs, .ys = ys, .vertices = n, .concave = concave, .sampler = SAMPLER_UNIFORM};
+    PolygonModel model;
+
+    measure("build", "model", &row, runBuild, &bench);
+
+    Point *points = generatePolygon(n, concave);
+    if (points == NULL || !buildPolygonModel(points, n, &model)) {
+        fprintf(stderr, "Failed to build the %s polygon of %d vertices\n", row.shape, n);
+        return;
+    }
+    bench.model = &model;
+
+    // O índice por faixas é medido mesmo quando o modelo o dispensa (convexo grande)
+    SlabIndex index;
+    int ringStart[2] = {0, n};
+    bool ownIndex = model.index.numSlabs == 0;
+    if (ownIndex && !buildSlabIndex(model.points, ringStart, 1, NULL, &index)) {
+        fprintf(stderr, "Failed to build the slab index of %d vertices\n", n);
+        freePolygonModel(&model);
+        return;
+    }
+    bench.index = ownIndex ? &index : &model.index;
+
+    measure("inside", "naive", &row, runNaive, &bench);
+    measure("inside", "slab", &row, runSlab, &bench);
+    if (model.convex.orientation != 0) measure("inside", "fan", &row, runFan, &bench);
+    measure("inside", model.grid.convex ? "grid+fan" : "grid+slab", &row, runGrid, &bench);
+    for (int d = DOMAIN_BOX; d <= DOMAIN_CELLS; d++) {
+        char variant[32];
+        bench.domain = (DomainKind)d;
+        snprintf(variant, sizeof(variant), "uniform/%s", domainName(bench.domain));
+        measure("chunk", variant, &row, runChunk, &bench);
+    }
+
+    if (ownIndex) freeSlabIndex(&index);
+    freePolygonModel(&model);
+}
+
+static double runScaling(void *ctx, long reps) {
+    const Bench *b = ctx;
+    EstimatorConfig config;
+    Tally tally;
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.workers = b->threads;
+    config.totalPoints = reps * CHUNK_POINTS;
+
+    if (!runEstimator(b->model, &config, &tally)) return -1;
+    benchSink += tally.hits;
+    return tally.samples;
+}
+
+/**
+ * @brief Samples per second of the threads backend for 1, 2, 4, ... threads.
+ */
+static void benchScaling(int maxThreads) {
+    PolygonModel model;
+    Point *points = generatePolygon(SCALING_VERTICES, true);
+    if (points == NULL || !buildPolygonModel(points, SCALING_VERTICES, &model)) {
+        fprintf(stderr, "Failed to build the scaling polygon\n");
+        return;
+    }
+
+    Bench bench = {.model = &model};
+    for (int t = 1;; t = t * 2 < maxThreads ? t * 2 : maxThreads) {
+        Row row = {"concave", SCALING_VERTICES, t};
+        bench.threads = t;
+        measure("scaling", "threads/uniform/box", &row, runScaling, &bench);
+        if (t == maxThreads) break;
+    }
+    freePolygonModel(&model);
+}
+
+/*
+ * Self-check: every fast inside test against the reference isInsidePolygon().
+ *
+ * The slab kernels (scalar, SSE2, AVX2), isInsideSlabIndex(), the convex fan
+ * and the grid in front of them must give the reference answer on every
+ * probe off the boundary. On the boundary itself the reference counts the
+ * point inside while the slab index uses half-open edges, and a horizontal
+ * ray through a vertex is ambiguous for the reference: such probes are only
+ * required to get the same answer from every slab kernel.
+ */
+typedef struct {
+    const char *shape;
+    const PolygonModel *model;
+    const SlabIndex *index;
+    SlabKernel kernels[3];
+    int numKernels;
+    int points;         // random and mapped probes
+    int lines;          // edges and lines probed
+    long probes;
+    long mismatches;
+} Check;
+
+static const char *KERNEL_NAMES[] = {"auto", "scalar", "sse2", "avx2"};
+
+/**
+ * @brief Even-odd answer of the reference test over every ring of the model.
+ */
+static bool referenceInside(const PolygonModel *model, Point p) {
+    bool inside = false;
+    for (int r = 0; r < model->numRings; r++) {
+        int first = model->ringStart[r];
+        inside ^= isInsidePolygon(model->points + first, model->ringStart[r + 1] - first, p);
+    }
+    return inside;
+}
+
+/**
+ * @brief Tells whether a probe lies on the boundary, or on the horizontal
+ * line of a vertex, where the answers legitimately differ.
+ */
+static bool onBoundary(const PolygonModel *model, Point p) {
+    for (int r = 0; r < model->numRings; r++) {
+        for (int i = model->ringStart[r]; i < model->ringStart[r + 1]; i++) {
+            Point a = model->points[i];
+            Point b = model->points[i + 1 < model->ringStart[r + 1] ? i + 1 : model->ringStart[r]];
+            if (fabs(p.y - a.y) < CHECK_TOLERANCE) return true;
+            if (p.y < fmin(a.y, b.y) - CHECK_TOLERANCE || p.y > fmax(a.y, b.y) + CHECK_TOLERANCE) continue;
+            double dx = b.x - a.x, dy = b.y - a.y;
+            double t = ((p.x - a.x) * dx + (p.y - a.y) * dy) / (dx * dx + dy * dy);
+            t = t < 0 ? 0 : t > 1 ? 1 : t;
+            if (hypot(a.x + t * dx - p.x, a.y + t * dy - p.y) < CHECK_TOLERANCE) return true;
+        }
+    }
+    return false;
+}
+
+static void reportMismatch(Check *check, const char *set, const char *path, Point p, bool expected) {
+    if (check->mismatches++ < MAX_REPORTED) {
+        printf("MISMATCH\t%s\t%d\t%s\t%s\t(%.17g, %.17g)\texpected %d\n", check->shape, check->model->numPoints, set,
+               path, p.x, p.y, expected);
+    }
+}
+
+/**
+ * @brief Runs a set of probes through every path and compares the answers.
+ */
+static void checkProbes(Check *check, const char *set, const double *xs, const double *ys, int count) {
+    const PolygonModel *model = check->model;
+    unsigned char *slab = malloc((size_t)count * 3);
+    unsigned char *fan = malloc(count), *grid = malloc(count);
+    if (slab == NULL || fan == NULL || grid == NULL) {
+        fprintf(stderr, "Out of memory in the self-check\n");
+        exit(1);
+    }
+
+    for (int k = 0; k < check->numKernels; k++) {
+        useSlabKernel(check->kernels[k]);
+        insideSlabBatch(check->index, xs, ys, count, slab + (size_t)k * count);
+    }
+    useSlabKernel(SLAB_KERNEL_AUTO);
+    if (model->convex.orientation != 0) insideConvexBatch(&model->convex, xs, ys, count, fan);
+    countInsideBatch(&model->grid, xs, ys, count, grid);
+
+    for (int i = 0; i < count; i++) {
+        Point p = {xs[i], ys[i]};
+        bool exact = isInsideSlabIndex(check->index, p);
+
+        // Na fronteira só se exige que os kernels concordem com o índice
+        bool boundary = onBoundary(model, p);
+        bool expected = boundary ? exact : referenceInside(model, p);
+        for (int k = 0; k < check->numKernels; k++) {
+            const char *kernel = KERNEL_NAMES[check->kernels[k]];
+            if (slab[(size_t)k * count + i] != expected) reportMismatch(check, set, kernel, p, expected);
+        }
+        if (boundary) continue;
+        if (exact != expected) reportMismatch(check, set, "slab index", p, expected);
+        if (model->convex.orientation != 0 && fan[i] != expected) reportMismatch(check, set, "fan", p, expected);
+        if (grid[i] != expected) reportMismatch(check, set, model->grid.convex ? "grid+fan" : "grid+slab", p, expected);
+    }
+    check->probes += count;
+
+    free(slab);
+    free(fan);
+    free(grid);
+}
+
+/**
+ * @brief Probes on the edges and vertices, and just off them on both sides.
+ */
+static void checkEdges(Check *check, Rng *rng) {
+    const PolygonModel *model = check->model;
+    int n = model->numPoints, step = n > check->lines ? n / check->lines : 1, count = 0;
+    double *xs = malloc(6 * sizeof(double) * (n / step + 1)), *ys = malloc(6 * sizeof(double) * (n / step + 1));
+    if (xs == NULL || ys == NULL) exit(1);
+
+    for (int r = 0; r < model->numRings; r++) {
+        for (int i = model->ringStart[r]; i < model->ringStart[r + 1]; i += step) {
+            Point a = model->points[i];
+            Point b = model->points[i + 1 < model->ringStart[r + 1] ? i + 1 : model->ringStart[r]];
+            double t = rngDouble(rng), length = hypot(b.x - a.x, b.y - a.y);
+            double nx = -(b.y - a.y) / length * CHECK_OFFSET, ny = (b.x - a.x) / length * CHECK_OFFSET;
+            Point on = {a.x + t * (b.x - a.x), a.y + t * (b.y - a.y)};
+            Point probes[6] = {a, on, {on.x + nx, on.y + ny}, {on.x - nx, on.y - ny},
+                               {a.x + CHECK_OFFSET, a.y + CHECK_OFFSET}, {a.x - CHECK_OFFSET, a.y - CHECK_OFFSET}};
+            for (int k = 0; k < 6; k++) {
+                xs[count] = probes[k].x;
+                ys[count++] = probes[k].y;
+            }
+        }
+    }
+    checkProbes(check, "edges", xs, ys, count);
+    free(xs);
+    free(ys);
+}
+
+/**
+ * @brief Probes on the lines between slabs and between grid cells.
+ */
+static void checkLines(Check *check, Rng *rng) {
+    const PolygonModel *model = check->model;
+    const SlabIndex *index = check->index;
+    const CellGrid *grid = &model->grid;
+    BoundingBox box = grid->box;
+    int lines = check->lines;
+    double xs[3 * CHECK_LINES], ys[3 * CHECK_LINES];
+
+    for (int k = 0; k < lines; k++) {
+        int slab = (int)((long)k * index->numSlabs / lines);
+        int col = (int)((long)k * grid->cols / lines), row = (int)((long)k * grid->rows / lines);
+        xs[k] = box.minX + rngDouble(rng) * (box.maxX - box.minX);
+        ys[k] = index->minY + slab / index->slabsPerUnit;
+        xs[lines + k] = box.minX + col / grid->cellsPerUnitX;
+        ys[lines + k] = box.minY + rngDouble(rng) * (box.maxY - box.minY);
+        xs[2 * lines + k] = box.minX + rngDouble(rng) * (box.maxX - box.minX);
+        ys[2 * lines + k] = box.minY + row / grid->cellsPerUnitY;
+    }
+    checkProbes(check, "slab and cell lines", xs, ys, 3 * lines);
+}
+
+/**
+ * @brief Random probes over the box and a margin around it, then random
+ * probes mapped onto the boundary cells, which must land in their cell.
+ */
+static void checkRandom(Check *check, Rng *rng) {
+    const CellGrid *grid = &check->model->grid;
+    BoundingBox box = grid->box;
+    double width = box.maxX - box.minX, height = box.maxY - box.minY;
+    int points = check->points;
+    static double xs[CHECK_POINTS], ys[CHECK_POINTS], us[CHECK_POINTS];
+
+    rngFillUniform(rng, xs, points, box.minX - 0.05 * width, box.maxX + 0.05 * width);
+    rngFillUniform(rng, ys, points, box.minY - 0.05 * height, box.maxY + 0.05 * height);
+    checkProbes(check, "random", xs, ys, points);
+
+    rngFillUniform(rng, xs, points, 0, 1);
+    rngFillUniform(rng, ys, points, 0, 1);
+    memcpy(us, xs, points * sizeof(double));
+    mapToBoundaryCells(grid, xs, ys, points);
+    for (int i = 0; i < points; i++) {
+        int cell = grid->boundaryCells[(int)(us[i] * grid->numBoundaryCells)];
+        double col = (xs[i] - box.minX) * grid->cellsPerUnitX - cell % grid->cols;
+        double row = (ys[i] - box.minY) * grid->cellsPerUnitY - cell / grid->cols;
+        if (col < -CHECK_TOLERANCE || col > 1 + CHECK_TOLERANCE || row < -CHECK_TOLERANCE || row > 1 + CHECK_TOLERANCE) {
+            reportMismatch(check, "boundary cells", "mapping", (Point){xs[i], ys[i]}, true);
+        }
+    }
+    checkProbes(check, "boundary cells", xs, ys, points);
+}
+
+/**
+ * @brief Checks every path on one model and prints its row.
+ */
+static void checkModel(const char *shape, PolygonModel *model, Check *totals) {
+    int scale = 1 + model->numPoints / CHECK_SCALE_VERTICES;
+    Check check = {.shape = shape, .model = model, .index = &model->index, .points = CHECK_POINTS / scale,
+                   .lines = CHECK_LINES / scale};
+    Rng rng;
+    rngSeed(&rng, 7);
+
+    // O modelo em leque não tem índice por faixas: constrói-se um só para o comparar
+    SlabIndex index;
+    bool ownIndex = model->index.numSlabs == 0;
+    if (ownIndex) {
+        if (!buildSlabIndex(model->points, model->ringStart, model->numRings, NULL, &index)) {
+            fprintf(stderr, "Failed to build the slab index of the %s polygon\n", shape);
+            exit(1);
+        }
+        check.index = &index;
+    }
+    for (int k = SLAB_KERNEL_SCALAR; k <= SLAB_KERNEL_AVX2; k++) {
+        if (useSlabKernel((SlabKernel)k)) check.kernels[check.numKernels++] = (SlabKernel)k;
+    }
+    useSlabKernel(SLAB_KERNEL_AUTO);
+
+    checkRandom(&check, &rng);
+    checkEdges(&check, &rng);
+    checkLines(&check, &rng);
+    printf("%s\t%d\t%s\t%ld\t%ld\n", shape, model->numPoints, model->grid.convex ? "grid+fan" : "grid+slab",
+           check.probes, check.mismatches);
+
+    totals->probes += check.probes;
+    totals->mismatches += check.mismatches;
+    if (ownIndex) freeSlabIndex(&index);
+    freePolygonModel(model);
+}
+
+/**
+ * @brief Builds a polygon with a hole: the concave flower around a square.
+ */
+static bool buildHoledModel(PolygonModel *model) {
+    int outer = 200;
+    Point *flower = generatePolygon(outer, true);
+    Point *points = flower != NULL ? realloc(flower, (outer + 4) * sizeof(Point)) : NULL;
+    int *ringStart = malloc(3 * sizeof(int)), *ringRegion = calloc(2, sizeof(int));
+    if (points == NULL || ringStart == NULL || ringRegion == NULL) {
+        free(points != NULL ? points : flower);
+        free(ringStart);
+        free(ringRegion);
+        return false;
+    }
+
+    Point square[4] = {{0.7, 0.7}, {1.3, 0.7}, {1.3, 1.3}, {0.7, 1.3}};
+    memcpy(points + outer, square, sizeof(square));
+    ringStart[0] = 0;
+    ringStart[1] = outer;
+    ringStart[2] = outer + 4;
+    return buildRegionsModel(points, ringStart, ringRegion, 2, 1, model);
+}
+
+/**
+ * @brief Compares every fast inside test with the reference on convex,
+ * concave and holed polygons, and on a convex polygon large enough to use
+ * the fan instead of the slab index.
+ * @return 0 if every answer matched, 1 otherwise.
+ */
+static int selfCheck(void) {
+    static const struct {
+        const char *shape;
+        int vertices;
+        bool concave;
+    } POLYGONS[] = {{"convex", 3, false}, {"convex", 1000, false}, {"concave", 10, true}, {"concave", 1000, true},
+                    {"convex", CONVEX_FAN_MIN_VERTICES, false}};
+    Check totals = {0};
+    PolygonModel model;
+
+    printf("shape\tvertices\tgrid\tprobes\tmismatches\n");
+    for (int k = 0; k < (int)(sizeof(POLYGONS) / sizeof(POLYGONS[0])); k++) {
+        Point *points = generatePolygon(POLYGONS[k].vertices, POLYGONS[k].concave);
+        if (points == NULL || !buildPolygonModel(points, POLYGONS[k].vertices, &model)) {
+            fprintf(stderr, "Failed to build the %s polygon of %d vertices\n", POLYGONS[k].shape, POLYGONS[k].vertices);
+            return 1;
+        }
+        checkModel(POLYGONS[k].shape, &model, &totals);
+    }
+    if (!buildHoledModel(&model)) {
+        fprintf(stderr, "Failed to build the polygon with a hole\n");
+        return 1;
+    }
+    checkModel("holed", &model, &totals);
+
+    printf("Slab kernels checked:");
+    for (int k = SLAB_KERNEL_SCALAR; k <= SLAB_KERNEL_AVX2; k++) {
+        if (useSlabKernel((SlabKernel)k)) printf(" %s", KERNEL_NAMES[k]);
+    }
+    useSlabKernel(SLAB_KERNEL_AUTO);
+    printf("\n%ld probes, %ld mismatches\n", totals.probes, totals.mismatches);
+    return totals.mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * Main function
+ *
+ * Micro-benchmarks of the geometry kernels, samplers and acceleration
+ * structures on synthetic polygons, printed as a tab-separated table.
+ */
+int main(int argc, char *argv[]) {
+    long maxVertices = DEFAULT_MAX_VERTICES;
+    long maxThreads = defaultWorkerCount();
+    bool check = takeFlag(&argc, argv, "--self-check");
+
+    if (!takeLongOption(&argc, argv, "--max-vertices", &maxVertices) || maxVertices < 3 ||
+        !takeLongOption(&argc, argv, "--threads", &maxThreads) || maxThreads < 1 ||
+        !takeDoubleOption(&argc, argv, "--min-time", &minTime) || minTime <= 0 || argc != 1) {
+        fprintf(stderr,
+                "Usage: %s [--max-vertices <n>] [--threads <max threads>] [--min-time <seconds>]\n"
+                "       %s --self-check\n"
+                "Prints one tab-separated row per measurement: kernel, shape, vertices, variant,\n"
+                "threads, operations, seconds, ns per operation and operations per second per core.\n"
+                "--self-check compares every fast inside test with isInsidePolygon() instead, and\n"
+                "exits with 1 on any mismatch.\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+    if (check) return selfCheck();
+
+    // Os mesmos pontos de consulta para todos os polígonos: a caixa comum [0, 2] x [0, 2]
+    static double xs[QUERY_POINTS], ys[QUERY_POINTS];
+    Rng rng;
+    rngSeed(&rng, 42);
+    rngFillUniform(&rng, xs, QUERY_POINTS, 0, 2);
+    rngFillUniform(&rng, ys, QUERY_POINTS, 0, 2);
+
+    printf("kernel\tshape\tvertices\tvariant\tthreads\toperations\tseconds\tns_per_op\tops_per_s_per_core\n");
+
+    Row primitive = {"-", 0, 1};
+    Bench bench = {.xs = xs, .ys = ys};
+    measure("orientation", "-", &primitive, runOrientation, &bench);
+    measure("doIntersect", "-", &primitive, runDoIntersect, &bench);
+    for (int s = SAMPLER_UNIFORM; s <= SAMPLER_SOBOL; s++) {
+        bench.sampler = (SamplerKind)s;
+        measure("sampler", samplerName(bench.sampler), &primitive, runSampler, &bench);
+    }
+
+    for (int k = 0; k < (int)(sizeof(SIZES) / sizeof(SIZES[0])) && SIZES[k] <= maxVertices; k++) {
+        benchPolygon(SIZES[k], false, xs, ys);
+        if (SIZES[k] >= 10) benchPolygon(SIZES[k], true, xs, ys);
+    }
+    benchScaling((int)maxThreads);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mc_polyfile.h"
+#include "mc_polygon.h"
+
+/**
+ * Main function
+ *
+ * Converts a text polygon file ("x,y," lines) into a binary polygon file
+ * that the estimators map and use without parsing or indexing it.
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <polygon text file> <binary output file>\n", argv[0]);
+        return 1;
+    }
+
+    PolygonModel model;
+    if (!loadPolygonModel(argv[1], &model)) return 1;
+
+    bool ok = savePolygonFile(argv[2], &model);
+    if (ok) {
+        printf("%s: %d vertices, %d slabs, %d edge entries, %d x %d cells%s\n", argv[2], model.numPoints,
+               model.index.numSlabs, model.index.slabStart[model.index.numSlabs], model.grid.cols, model.grid.rows,
+               model.convex.orientation != 0 ? ", convex" : "");
+    }
+
+    freePolygonModel(&model);
+    return ok ? 0 : 1;
+}
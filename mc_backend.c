@@ -0,0 +1,189 @@
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "mc_backend.h"
+
+/**
+ * @brief Forks one child per worker. Each child runs body and exits without
+ * returning to the caller.
+ * @param workers Number of children.
+ * @param body Function run by each child.
+ * @param ctx Context passed to body.
+ * @param pids Output array of workers entries receiving the children's pids.
+ * @return false if a fork failed; the children already started are then
+ * killed and reaped.
+ */
+bool forkWorkers(int workers, WorkerMain body, void *ctx, pid_t *pids) {
+    for (int i = 0; i < workers; i++) {
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            // _exit: os buffers de stdio herdados do pai não são escritos outra vez
+            _exit(body(i, ctx) ? 0 : 1);
+        }
+        if (pids[i] < 0) {
+            perror("Fork failed");
+            for (int k = 0; k < i; k++) kill(pids[k], SIGTERM);
+            for (int k = 0; k < i; k++) waitpid(pids[k], NULL, 0);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for every child started by forkWorkers().
+ * @param pids Pids of the children.
+ * @param workers Number of children.
+ * @return false if a child failed or was killed.
+ */
+bool waitWorkers(const pid_t *pids, int workers) {
+    bool ok = true;
+    for (int i = 0; i < workers; i++) {
+        int status;
+        if (waitpid(pids[i], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief Waits for every child started by forkWorkers() without polling:
+ * one pidfd per child and an optional timerfd are watched with poll(), so
+ * the parent wakes exactly when a child exits or a tick is due.
+ * @param pids Pids of the children; they are reaped here.
+ * @param workers Number of children.
+ * @param tickMs Interval between calls of tick, in milliseconds.
+ * @param tick Optional function (may be NULL) called every tickMs while children run.
+ * @param ctx Context passed to tick.
+ * @return false if a child failed or the wait itself failed.
+ */
+bool awaitWorkers(const pid_t *pids, int workers, int tickMs, TickFn tick, void *ctx) {
+    struct pollfd *fds = malloc((workers + 1) * sizeof(struct pollfd));
+    if (fds == NULL) return false;
+
+    bool ok = true;
+    int remaining = 0;
+    for (int i = 0; i < workers; i++) {
+        fds[i].fd = syscall(SYS_pidfd_open, pids[i], 0);
+        fds[i].events = POLLIN;
+        if (fds[i].fd == -1) {
+            // Sem pidfd para este filho: esperar por ele já, em bloqueio
+            int status;
+            if (waitpid(pids[i], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+        } else {
+            remaining++;
+        }
+    }
+
+    fds[workers].fd = -1;
+    fds[workers].events = POLLIN;
+    if (tick != NULL) {
+        struct itimerspec interval = {{tickMs / 1000, tickMs % 1000 * 1000000L}, {tickMs / 1000, tickMs % 1000 * 1000000L}};
+        fds[workers].fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (fds[workers].fd != -1) timerfd_settime(fds[workers].fd, 0, &interval, NULL);
+    }
+
+    while (remaining > 0) {
+        if (poll(fds, workers + 1, -1) == -1) {
+            if (errno == EINTR) continue;
+            perror("poll failed");
+            ok = false;
+            break;
+        }
+
+        if (fds[workers].fd != -1 && (fds[workers].revents & POLLIN)) {
+            uint64_t expirations;
+            if (read(fds[workers].fd, &expirations, sizeof(expirations)) > 0) tick(ctx);
+        }
+        for (int i = 0; i < workers; i++) {
+            if (fds[i].fd == -1 || !(fds[i].revents & POLLIN)) continue;
+
+            int status;
+            if (waitpid(pids[i], &status, 0) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+            close(fds[i].fd);
+            fds[i].fd = -1;  // poll ignora descritores negativos
+            remaining--;
+        }
+    }
+
+    for (int i = 0; i <= workers; i++) {
+        if (fds[i].fd != -1) close(fds[i].fd);
+    }
+    free(fds);
+    return ok;
+}
+
+/**
+ * @brief Samples the static share of chunks of one worker.
+ * @param model Polygon to sample.
+ * @param config Configuration of the run.
+ * @param worker Worker number.
+ * @param sink Optional callback (may be NULL) receiving every batch.
+ * @param ctx Context passed to sink.
+ * @return Sum of the tallies of the worker's chunks.
+ */
+Tally sampleWorkerChunks(const PolygonModel *model, const EstimatorConfig *config, int worker,
+                         BatchSink sink, void *ctx) {
+    Tally total = {0, 0};
+    long first, last;
+
+    workerChunks(config, worker, &first, &last);
+    for (long c = first; c < last; c++) {
+        Tally t = sampleChunk(model, config, c, sink, ctx);
+        total.samples += t.samples;
+        total.hits += t.hits;
+    }
+    return total;
+}
+
+/**
+ * @brief Reads exactly n bytes unless end of file comes first.
+ * @return Bytes read, or -1 if the first read failed.
+ */
+ssize_t readn(int fd, void *ptr, size_t n) {
+    size_t nleft = n;
+    ssize_t nread;
+
+    while (nleft > 0) {
+        if ((nread = read(fd, ptr, nleft)) < 0) {
+            if (nleft == n)
+                return -1;
+            else
+                break;
+        } else if (nread == 0) {
+            break;
+        }
+
+        nleft -= nread;
+        ptr = (char *)ptr + nread;
+    }
+    return (n - nleft);
+}
+
+/**
+ * @brief Writes exactly n bytes unless an error occurs.
+ * @return Bytes written, or -1 if the first write failed.
+ */
+ssize_t writen(int fd, const void *ptr, size_t n) {
+    size_t nleft = n;
+    ssize_t nwritten;
+
+    while (nleft > 0) {
+        if ((nwritten = write(fd, ptr, nleft)) <= 0) {
+            if (nwritten < 0 && nleft == n)
+                return -1;
+            else
+                break;
+        }
+
+        nleft -= nwritten;
+        ptr = (const char *)ptr + nwritten;
+    }
+    return (n - nleft);
+}
@@ -0,0 +1,41 @@
+#ifndef MC_BACKEND_H
+#define MC_BACKEND_H
+
+#include <sys/types.h>
+#include "mc_estimator.h"
+
+/*
+ * Backends of runEstimator(). Each one runs config->workers workers over
+ * the chunks of the run and sums their tallies; config->workers is already
+ * resolved (at least 1).
+ */
+bool runFileBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool runPipeBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool runSocketBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool runThreadsBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool runRingBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool runThreadsRegions(const PolygonModel *model, const EstimatorConfig *config, Tally *tally, long *regionHits);
+
+/**
+ * @brief Body of a forked worker; the child exits when it returns.
+ * @param worker Worker number, in [0, workers).
+ * @param ctx Context given to forkWorkers().
+ * @return false if the worker failed (the child exits with status 1).
+ */
+typedef bool (*WorkerMain)(int worker, void *ctx);
+
+/**
+ * @brief Called periodically by awaitWorkers() while children run.
+ * @param ctx Context given to awaitWorkers().
+ */
+typedef void (*TickFn)(void *ctx);
+
+bool forkWorkers(int workers, WorkerMain body, void *ctx, pid_t *pids);
+bool waitWorkers(const pid_t *pids, int workers);
+bool awaitWorkers(const pid_t *pids, int workers, int tickMs, TickFn tick, void *ctx);
+Tally sampleWorkerChunks(const PolygonModel *model, const EstimatorConfig *config, int worker,
+                         BatchSink sink, void *ctx);
+ssize_t readn(int fd, void *ptr, size_t n);
+ssize_t writen(int fd, const void *ptr, size_t n);
+
+#endif
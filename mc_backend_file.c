@@ -0,0 +1,74 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include "mc_backend.h"
+
+#define RESULTS_FILE "resultados.txt"
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    int fd;
+} FileRun;
+
+/**
+ * @brief Child of the file backend: appends "pid;samples;hits" to the results file.
+ */
+static bool fileWorker(int worker, void *ctx) {
+    FileRun *run = ctx;
+    Tally t = sampleWorkerChunks(run->model, run->config, worker, NULL, NULL);
+
+    char resultado[100];
+    int len = snprintf(resultado, sizeof(resultado), "%d;%ld;%ld\n", getpid(), t.samples, t.hits);
+
+    // Um registo inteiro por escrita, com o ficheiro bloqueado
+    flock(run->fd, LOCK_EX);
+    ssize_t written = writen(run->fd, resultado, len);
+    flock(run->fd, LOCK_UN);
+    close(run->fd);
+    return written == len;
+}
+
+/**
+ * @brief fork + file backend: children write their tallies to resultados.txt,
+ * which the parent reads back once every child has exited.
+ */
+bool runFileBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    int fd = open(RESULTS_FILE, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd == -1) {
+        perror("Error opening the results file");
+        return false;
+    }
+
+    pid_t *pids = malloc(config->workers * sizeof(pid_t));
+    FileRun run = {model, config, fd};
+    bool ok = pids != NULL && forkWorkers(config->workers, fileWorker, &run, pids);
+    if (ok) ok = waitWorkers(pids, config->workers);
+    close(fd);
+    free(pids);
+    if (!ok) return false;
+
+    FILE *results = fopen(RESULTS_FILE, "r");
+    if (results == NULL) {
+        perror("Error reading the results file");
+        return false;
+    }
+
+    long samples, hits;
+    int records = 0;
+    while (fscanf(results, "%*d;%ld;%ld\n", &samples, &hits) == 2) {
+        tally->samples += samples;
+        tally->hits += hits;
+        records++;
+    }
+    fclose(results);
+
+    if (records != config->workers) {
+        fprintf(stderr, "Expected %d results in %s, found %d\n", config->workers, RESULTS_FILE, records);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_protocol.h"
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    int pipefd[2];
+} PipeRun;
+
+typedef struct {
+    RecordWriter writer;
+    bool verbose;
+} PipeSink;
+
+/**
+ * @brief Adds a batch to the worker's record; in verbose mode also its points inside.
+ */
+static bool recordBatch(void *ctx, const double *xs, const double *ys,
+                        const unsigned char *inside, int count, int hits) {
+    PipeSink *sink = ctx;
+
+    recordCounts(&sink->writer, count, hits);
+    if (sink->verbose) {
+        for (int i = 0; i < count; i++) {
+            if (inside[i] && !recordPoint(&sink->writer, (Point){xs[i], ys[i]})) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Child of the pipe backend: sends one record per chunk (more in
+ * verbose mode, when the points inside overflow a record).
+ */
+static bool pipeWorker(int worker, void *ctx) {
+    PipeRun *run = ctx;
+    PipeSink sink = {.verbose = run->config->verbose};
+    long first, last;
+    bool ok = true;
+
+    close(run->pipefd[0]);
+    initRecordWriter(&sink.writer, run->pipefd[1], worker);
+    workerChunks(run->config, worker, &first, &last);
+    for (long c = first; c < last && ok; c++) {
+        sampleChunk(run->model, run->config, c, recordBatch, &sink);
+        // Um registo por bloco dá ao pai o progresso; o último vai com RECORD_FINAL
+        ok = c + 1 == last || flushRecord(&sink.writer, false);
+    }
+    ok = ok && flushRecord(&sink.writer, true);
+    close(run->pipefd[1]);
+    return ok;
+}
+
+/**
+ * @brief fork + pipe backend: every child writes binary records to one pipe
+ * read by the parent.
+ *
+ * Records are at most PIPE_BUF bytes, so the writes of different children
+ * never interleave. In verbose mode the parent prints every point inside.
+ */
+bool runPipeBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    PipeRun run = {model, config, {-1, -1}};
+    if (pipe(run.pipefd) == -1) {
+        perror("Error creating the pipe");
+        return false;
+    }
+
+    pid_t *pids = malloc(config->workers * sizeof(pid_t));
+    if (pids == NULL || !forkWorkers(config->workers, pipeWorker, &run, pids)) {
+        close(run.pipefd[0]);
+        close(run.pipefd[1]);
+        free(pids);
+        return false;
+    }
+    close(run.pipefd[1]); // Fecha o lado de escrita no processo pai
+
+    ResultRecord record;
+    Point points[RECORD_MAX_POINTS];
+    int finished = 0, status;
+    while ((status = readRecord(run.pipefd[0], &record, points)) > 0) {
+        for (uint32_t i = 0; i < record.numPoints; i++) {
+            printf("%d;%f;%f\n", record.worker, points[i].x, points[i].y);
+        }
+        tally->samples += record.samples;
+        tally->hits += record.hits;
+        finished += (record.flags & RECORD_FINAL) != 0;
+        if (config->showProgress && !config->verbose) displayProgress(tally->samples, config->totalPoints);
+    }
+    close(run.pipefd[0]);
+    if (config->showProgress && !config->verbose) printf("\n");
+
+    bool ok = waitWorkers(pids, config->workers) && status == 0 && finished == config->workers;
+    free(pids);
+    return ok;
+}
@@ -0,0 +1,139 @@
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include "mc_backend.h"
+#include "mc_ring.h"
+
+#define RING_WAIT_MS 100
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    RingSet *set;
+} RingRun;
+
+typedef struct {
+    RingSet *set;
+    PointRing *ring;
+    bool verbose;
+} RingSink;
+
+/**
+ * @brief Publishes a batch: its points inside (verbose mode), then its counts.
+ */
+static bool pushBatch(void *ctx, const double *xs, const double *ys,
+                      const unsigned char *inside, int count, int hits) {
+    RingSink *sink = ctx;
+
+    if (sink->verbose && hits > 0) {
+        Point points[BATCH_SIZE];
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (inside[i]) points[n++] = (Point){xs[i], ys[i]};
+        }
+        if (!ringPush(sink->set, sink->ring, points, n)) return false;
+    }
+    counterAdd(&sink->ring->counter, count, hits);
+    return true;
+}
+
+/**
+ * @brief Child of the ring backend: samples its chunks into its own ring.
+ */
+static bool ringWorker(int worker, void *ctx) {
+    RingRun *run = ctx;
+    RingSink sink = {run->set, &run->set->rings[worker], run->config->verbose};
+
+    sampleWorkerChunks(run->model, run->config, worker, pushBatch, &sink);
+    ringFinish(run->set, sink.ring);
+    return true;
+}
+
+/**
+ * @brief Tells whether a child has exited, without reaping it.
+ */
+static bool workerExited(pid_t pid) {
+    siginfo_t info = {0};
+    return waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == pid;
+}
+
+/**
+ * @brief Parent side: drains every ring until all workers have finished.
+ * @return false if a worker died before finishing its ring.
+ */
+static bool drainRings(RingSet *set, const EstimatorConfig *config, const pid_t *pids) {
+    Point points[BATCH_SIZE];
+    int finished = 0;
+
+    while (finished < set->workers) {
+        bool any = false;
+        for (int i = 0; i < set->workers; i++) {
+            PointRing *ring = &set->rings[i];
+            // finished é lido antes de esvaziar: depois dele não chegam mais pontos
+            bool done = !ring->finishedSeen && atomic_load(&ring->finished);
+            int n;
+            while ((n = ringPop(ring, points, BATCH_SIZE)) > 0) {
+                for (int k = 0; k < n; k++) printf("%d;%f;%f\n", i, points[k].x, points[k].y);
+                any = true;
+            }
+            if (done) {
+                ring->finishedSeen = true;
+                finished++;
+                any = true;
+            }
+        }
+
+        if (config->showProgress && !config->verbose) {
+            long checked = 0;
+            for (int i = 0; i < set->workers; i++) checked += sumCounters(&set->rings[i].counter, 1, NULL);
+            displayProgress(checked, config->totalPoints);
+        }
+
+        if (!any && !ringSetWait(set, RING_WAIT_MS)) {
+            for (int i = 0; i < set->workers; i++) {
+                if (!set->rings[i].finishedSeen && !atomic_load(&set->rings[i].finished) && workerExited(pids[i])) {
+                    fprintf(stderr, "Worker %d exited before finishing\n", i);
+                    return false;
+                }
+            }
+        }
+    }
+
+    if (config->showProgress && !config->verbose) printf("\n");
+    return true;
+}
+
+/**
+ * @brief fork + shared-memory ring backend: every child streams its points
+ * inside through its own lock-free ring and publishes its counts in the
+ * ring's counter.
+ */
+bool runRingBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    RingSet *set = createRingSet(config->workers);
+    if (set == NULL) return false;
+
+    pid_t *pids = malloc(config->workers * sizeof(pid_t));
+    RingRun run = {model, config, set};
+    if (pids == NULL || !forkWorkers(config->workers, ringWorker, &run, pids)) {
+        destroyRingSet(set);
+        free(pids);
+        return false;
+    }
+
+    bool drained = drainRings(set, config, pids);
+    if (!drained) {
+        for (int i = 0; i < config->workers; i++) kill(pids[i], SIGTERM);
+    }
+    bool ok = waitWorkers(pids, config->workers) && drained;
+
+    for (int i = 0; i < config->workers; i++) {
+        long hits;
+        tally->samples += sumCounters(&set->rings[i].counter, 1, &hits);
+        tally->hits += hits;
+    }
+
+    destroyRingSet(set);
+    free(pids);
+    return ok;
+}
@@ -0,0 +1,367 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_progress.h"
+#include "mc_protocol.h"
+
+#define SOCKET_PATH_PREFIX "/tmp/monte_carlo_socket"
+#define PROGRESS_TICK_MS 100
+#define MAX_EVENTS 64
+
+// Etiquetas dos descritores no epoll: escuta, temporizador, pidfds, ligações
+#define TAG_LISTEN 0
+#define TAG_TIMER 1
+#define TAG_CHILD(i) (2 + (i))
+#define TAG_CONNECTION(workers, k) (2 + (workers) + (k))
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    WorkerCounter *counters;
+    struct sockaddr_un addr;
+} SocketRun;
+
+typedef struct {
+    WorkerCounter *counter;
+} CounterSink;
+
+/*
+ * Parent-side state of one accepted connection: bytes received but not yet
+ * decoded, since a non-blocking read may stop in the middle of a record.
+ */
+typedef struct {
+    int fd;
+    int worker;  // -1 until its first record arrives
+    size_t used;
+    unsigned char buffer[RECORD_MAX_SIZE];
+} Connection;
+
+typedef struct {
+    const SocketRun *run;
+    int epfd;
+    int listenfd;
+    int timerfd;
+    pid_t *pids;
+    int *pidfds;
+    Connection *connections;
+    int numConnections;
+    bool *finalSeen;
+    int finals;
+    int reaped;
+    Tally tally;
+} Collector;
+
+/**
+ * @brief Publishes a finished batch on the worker's own shared counter.
+ */
+static bool addProgress(void *ctx, const double *xs, const double *ys,
+                        const unsigned char *inside, int count, int hits) {
+    (void)xs, (void)ys, (void)inside;
+    counterAdd(((CounterSink *)ctx)->counter, count, hits);
+    return true;
+}
+
+/**
+ * @brief Child of the socket backend: connects once, then sends a partial
+ * result record after every chunk and a final record at the end.
+ */
+static bool socketWorker(int worker, void *ctx) {
+    SocketRun *run = ctx;
+    CounterSink sink = {&run->counters[worker]};
+
+    int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sockfd < 0 || connect(sockfd, (struct sockaddr *)&run->addr, sizeof(run->addr)) == -1) {
+        perror("Failed to connect to the parent");
+        return false;
+    }
+
+    RecordWriter writer;
+    long first, last;
+    bool ok = true;
+    initRecordWriter(&writer, sockfd, worker);
+    workerChunks(run->config, worker, &first, &last);
+    for (long c = first; c < last && ok; c++) {
+        Tally t = sampleChunk(run->model, run->config, c, addProgress, &sink);
+        recordCounts(&writer, t.samples, t.hits);
+        ok = flushRecord(&writer, c + 1 == last);
+    }
+    if (ok && first == last) ok = flushRecord(&writer, true);
+
+    close(sockfd);
+    return ok;
+}
+
+/**
+ * @brief Registers a descriptor in the epoll set under a tag.
+ */
+static bool watch(int epfd, int fd, uint32_t tag) {
+    struct epoll_event event = {.events = EPOLLIN, .data.u32 = tag};
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/**
+ * @brief Accepts every pending connection.
+ */
+static bool acceptConnections(Collector *c) {
+    for (;;) {
+        int fd = accept(c->listenfd, NULL, NULL);
+        if (fd == -1) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+
+        int workers = c->run->config->workers;
+        if (c->numConnections == workers) {
+            fprintf(stderr, "Unexpected connection\n");
+            close(fd);
+            continue;
+        }
+        Connection *conn = &c->connections[c->numConnections];
+        conn->fd = fd;
+        conn->worker = -1;
+        conn->used = 0;
+        if (!watch(c->epfd, fd, TAG_CONNECTION(workers, c->numConnections))) {
+            close(fd);
+            return false;
+        }
+        c->numConnections++;
+    }
+}
+
+/**
+ * @brief Reads what a connection has available and adds its complete records.
+ * @return false on a corrupt record, or if the connection closed before its final record.
+ */
+static bool receiveRecords(Collector *c, Connection *conn) {
+    for (;;) {
+        ssize_t got = read(conn->fd, conn->buffer + conn->used, sizeof(conn->buffer) - conn->used);
+        if (got == -1) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        if (got == 0) {
+            epoll_ctl(c->epfd, EPOLL_CTL_DEL, conn->fd, NULL);
+            close(conn->fd);
+            conn->fd = -1;
+            return conn->worker >= 0 && c->finalSeen[conn->worker] && conn->used == 0;
+        }
+        conn->used += got;
+
+        ResultRecord record;
+        Point points[RECORD_MAX_POINTS];
+        long taken;
+        while ((taken = parseRecord(conn->buffer, conn->used, &record, points)) > 0) {
+            if (record.worker < 0 || record.worker >= c->run->config->workers ||
+                c->finalSeen[record.worker] || (conn->worker >= 0 && conn->worker != record.worker)) {
+                fprintf(stderr, "Unexpected result record\n");
+                return false;
+            }
+            conn->worker = record.worker;
+            c->tally.samples += record.samples;
+            c->tally.hits += record.hits;
+            if (record.flags & RECORD_FINAL) {
+                c->finalSeen[record.worker] = true;
+                c->finals++;
+            }
+            memmove(conn->buffer, conn->buffer + taken, conn->used - taken);
+            conn->used -= taken;
+        }
+        if (taken < 0) return false;
+    }
+}
+
+/**
+ * @brief Area estimate of a tally of the run.
+ */
+static double runArea(const SocketRun *run, const Tally *tally) {
+    double domainArea, knownArea;
+    samplingAreas(run->model, run->config->domain, &domainArea, &knownArea);
+    return knownArea + (tally->samples > 0 ? domainArea * tally->hits / tally->samples : 0);
+}
+
+/**
+ * @brief Progress tick: progress bar from the counters, estimate so far from the records.
+ */
+static void showIntermediate(Collector *c) {
+    const EstimatorConfig *config = c->run->config;
+    uint64_t expirations;
+    if (read(c->timerfd, &expirations, sizeof(expirations)) <= 0) return;
+
+    displayProgress(sumCounters(c->run->counters, config->workers, NULL), config->totalPoints);
+    if (c->tally.samples > 0) {
+        printf("  area ~ %f", runArea(c->run, &c->tally));
+        fflush(stdout);
+    }
+}
+
+/**
+ * @brief Reaps a child whose pidfd fired.
+ */
+static bool reapChild(Collector *c, int worker) {
+    int status;
+    epoll_ctl(c->epfd, EPOLL_CTL_DEL, c->pidfds[worker], NULL);
+    close(c->pidfds[worker]);
+    c->pidfds[worker] = -1;
+    c->reaped++;
+    bool ok = waitpid(c->pids[worker], &status, 0) != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    c->pids[worker] = -1;
+    return ok;
+}
+
+/**
+ * @brief Parent side: one epoll loop accepts connections, decodes partial
+ * results, reaps children and ticks the progress display, all while the
+ * children run. It ends once every child has sent its final record and exited.
+ */
+static bool collectResults(Collector *c) {
+    int workers = c->run->config->workers;
+    struct epoll_event events[MAX_EVENTS];
+    bool ok = true;
+
+    while (ok && (c->finals < workers || c->reaped < workers)) {
+        int n = epoll_wait(c->epfd, events, MAX_EVENTS, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            return false;
+        }
+
+        for (int e = 0; e < n && ok; e++) {
+            uint32_t tag = events[e].data.u32;
+            if (tag == TAG_LISTEN) {
+                ok = acceptConnections(c);
+            } else if (tag == TAG_TIMER) {
+                showIntermediate(c);
+            } else if (tag < (uint32_t)TAG_CHILD(workers)) {
+                ok = reapChild(c, tag - TAG_CHILD(0));
+            } else {
+                Connection *conn = &c->connections[tag - TAG_CONNECTION(workers, 0)];
+                if (conn->fd != -1) ok = receiveRecords(c, conn);
+            }
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Sets up the epoll set: listening socket, progress timer and one
+ * pidfd per child.
+ */
+static bool initCollector(Collector *c, const SocketRun *run, int listenfd, pid_t *pids) {
+    int workers = run->config->workers;
+    memset(c, 0, sizeof(*c));
+    c->run = run;
+    c->epfd = -1;
+    c->listenfd = listenfd;
+    c->timerfd = -1;
+    c->pids = pids;
+    c->pidfds = malloc(workers * sizeof(int));
+    c->connections = malloc(workers * sizeof(Connection));
+    c->finalSeen = calloc(workers, sizeof(bool));
+    if (c->pidfds == NULL || c->connections == NULL || c->finalSeen == NULL) return false;
+
+    for (int i = 0; i < workers; i++) c->pidfds[i] = -1;
+    c->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (c->epfd == -1) return false;
+    if (!watch(c->epfd, listenfd, TAG_LISTEN)) return false;
+
+    if (run->config->showProgress) {
+        long ns = PROGRESS_TICK_MS * 1000000L;
+        struct itimerspec interval = {{0, ns}, {0, ns}};
+        c->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (c->timerfd == -1 || timerfd_settime(c->timerfd, 0, &interval, NULL) == -1 ||
+            !watch(c->epfd, c->timerfd, TAG_TIMER)) return false;
+    }
+
+    for (int i = 0; i < workers; i++) {
+        c->pidfds[i] = syscall(SYS_pidfd_open, pids[i], 0);
+        if (c->pidfds[i] == -1 || !watch(c->epfd, c->pidfds[i], TAG_CHILD(i))) {
+            perror("pidfd_open failed");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Releases the collector; children not reaped yet are killed and reaped.
+ */
+static void freeCollector(Collector *c) {
+    int workers = c->run->config->workers;
+    for (int i = 0; i < workers; i++) {
+        if (c->pidfds != NULL && c->pidfds[i] != -1) close(c->pidfds[i]);
+        if (c->pids[i] == -1) continue;
+        kill(c->pids[i], SIGTERM);
+        waitpid(c->pids[i], NULL, 0);
+    }
+    for (int k = 0; k < c->numConnections; k++) {
+        if (c->connections[k].fd != -1) close(c->connections[k].fd);
+    }
+    if (c->timerfd != -1) close(c->timerfd);
+    if (c->epfd != -1) close(c->epfd);
+    free(c->pidfds);
+    free(c->connections);
+    free(c->finalSeen);
+}
+
+/**
+ * @brief fork + AF_UNIX socket backend: progress in per-worker counters in
+ * anonymous shared memory, partial results over one persistent connection
+ * per child, collected by an epoll loop while the children run.
+ *
+ * The socket path carries the parent's pid and the counters have no key,
+ * so concurrent runs never share either.
+ */
+bool runSocketBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    SocketRun run = {model, config, createSharedCounters(config->workers), {.sun_family = AF_UNIX}};
+    if (run.counters == NULL) {
+        perror("Failed to map the progress counters");
+        return false;
+    }
+    snprintf(run.addr.sun_path, sizeof(run.addr.sun_path), "%s.%d", SOCKET_PATH_PREFIX, (int)getpid());
+
+    int server_sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_sockfd < 0) {
+        perror("Socket creation failed");
+        destroySharedCounters(run.counters, config->workers);
+        return false;
+    }
+
+    fcntl(server_sockfd, F_SETFL, O_NONBLOCK);
+    unlink(run.addr.sun_path);
+    if (bind(server_sockfd, (struct sockaddr *)&run.addr, sizeof(run.addr)) == -1 ||
+        listen(server_sockfd, SOMAXCONN) == -1) {
+        perror("Failed to bind or listen on socket");
+        close(server_sockfd);
+        destroySharedCounters(run.counters, config->workers);
+        return false;
+    }
+
+    pid_t *pids = malloc(config->workers * sizeof(pid_t));
+    bool ok = pids != NULL && forkWorkers(config->workers, socketWorker, &run, pids);
+    if (ok) {
+        Collector collector;
+        ok = initCollector(&collector, &run, server_sockfd, pids) && collectResults(&collector);
+        *tally = collector.tally;
+        freeCollector(&collector);
+    }
+
+    if (ok && config->showProgress) {
+        displayProgress(tally->samples, config->totalPoints);
+        printf("  area ~ %f\n", runArea(&run, tally));
+    }
+
+    close(server_sockfd);
+    unlink(run.addr.sun_path);
+    destroySharedCounters(run.counters, config->workers);
+    free(pids);
+    return ok;
+}
@@ -0,0 +1,141 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_pool.h"
+#include "mc_progress.h"
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    WorkerCounter *counters;
+    long *regionHits;   // config->workers rows of regionStride counters, or NULL
+    long regionStride;  // numRegions rounded up to a cache line
+    atomic_bool stopSampling;
+    atomic_bool progressDone;
+} ThreadsRun;
+
+typedef struct {
+    ThreadsRun *run;
+    int worker;
+} ThreadSink;
+
+/**
+ * @brief Publishes a batch on the worker's counter; stops once the target is met.
+ */
+static bool publishBatch(void *ctx, const double *xs, const double *ys,
+                         const unsigned char *inside, int count, int hits) {
+    ThreadSink *sink = ctx;
+    (void)xs, (void)ys, (void)inside;
+
+    counterAdd(&sink->run->counters[sink->worker], count, hits);
+    return !atomic_load_explicit(&sink->run->stopSampling, memory_order_relaxed);
+}
+
+/**
+ * @brief Samples one chunk; run by the worker pool.
+ * @return Number of points of the chunk inside the polygon.
+ */
+static long sampleThreadChunk(void *ctx, long chunk, int worker) {
+    ThreadsRun *run = ctx;
+    if (atomic_load_explicit(&run->stopSampling, memory_order_relaxed)) return 0;
+
+    ThreadSink sink = {run, worker};
+    long *regionHits = run->regionHits ? run->regionHits + worker * run->regionStride : NULL;
+    return sampleChunkRegions(run->model, run->config, chunk, publishBatch, &sink, regionHits).hits;
+}
+
+/**
+ * @brief Progress thread: sums the counters every 10 ms, draws the progress
+ * bar and, in adaptive mode, stops the workers once the target is met.
+ */
+static void *monitorProgress(void *arg) {
+    ThreadsRun *run = arg;
+    const EstimatorConfig *config = run->config;
+    int previousProgress = -1;
+    double domainArea, knownArea;
+
+    samplingAreas(run->model, config->domain, &domainArea, &knownArea);
+
+    while (!atomic_load(&run->progressDone)) {
+        long hits;
+        long checked = sumCounters(run->counters, config->workers, &hits);
+
+        if (targetReached(&config->rule, domainArea, knownArea, checked, hits)) {
+            atomic_store(&run->stopSampling, true);
+        }
+
+        int progress = (double)checked / config->totalPoints * 100;
+        if (config->showProgress && progress != previousProgress) {
+            displayProgress(checked, config->totalPoints);
+            previousProgress = progress;
+        }
+
+        usleep(10000);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief pthreads backend: a work-stealing pool over the chunks of the run,
+ * with one padded progress counter per thread.
+ */
+bool runThreadsBackend(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    return runThreadsRegions(model, config, tally, NULL);
+}
+
+/**
+ * @brief runThreadsBackend() that also counts the samples inside each region.
+ * @param model Polygon to sample.
+ * @param config Configuration of the run (workers already resolved).
+ * @param tally Output: samples drawn and samples inside the union of the regions.
+ * @param regionHits Optional (may be NULL) output: model->numRegions counters.
+ * @return false if the run failed.
+ */
+bool runThreadsRegions(const PolygonModel *model, const EstimatorConfig *config, Tally *tally, long *regionHits) {
+    ThreadsRun run = {model, config, createCounters(config->workers), NULL, 0, false, false};
+    if (run.counters == NULL) {
+        fprintf(stderr, "Failed to allocate the progress counters\n");
+        return false;
+    }
+    // Uma linha de contadores por thread, alinhada à cache: cada uma só escreve na sua
+    if (regionHits) {
+        run.regionStride = (model->numRegions + 7) / 8 * 8;
+        size_t bytes = config->workers * run.regionStride * sizeof(long);
+        run.regionHits = aligned_alloc(64, bytes);
+        if (run.regionHits) memset(run.regionHits, 0, bytes);
+        if (run.regionHits == NULL) {
+            fprintf(stderr, "Failed to allocate the region counters\n");
+            destroyCounters(run.counters);
+            return false;
+        }
+    }
+
+    // Sem barra nem regra de paragem o monitor só atrasaria o fim da corrida até 10 ms
+    pthread_t progressThread;
+    bool monitored = (config->showProgress || stopRuleActive(&config->rule)) &&
+                     pthread_create(&progressThread, NULL, monitorProgress, &run) == 0;
+    bool ok = runWorkPool(config->workers, chunkCount(config), sampleThreadChunk, &run, NULL);
+    if (!ok) fprintf(stderr, "Failed to start the worker threads\n");
+
+    atomic_store(&run.progressDone, true);
+    if (monitored) pthread_join(progressThread, NULL);
+
+    tally->samples = sumCounters(run.counters, config->workers, &tally->hits);
+    if (config->showProgress) {
+        displayProgress(tally->samples, config->totalPoints);
+        printf("\n");
+    }
+
+    for (int w = 0; regionHits && w < config->workers; w++) {
+        for (int r = 0; r < model->numRegions; r++) regionHits[r] += run.regionHits[w * run.regionStride + r];
+    }
+
+    free(run.regionHits);
+    destroyCounters(run.counters);
+    return ok;
+}
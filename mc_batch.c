@@ -0,0 +1,239 @@
+#include <stddef.h>
+#include "mc_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+#endif
+
+typedef void (*BatchKernel)(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside);
+
+static BatchKernel slabKernel;     // chosen on first use, or by useSlabKernel()
+
+/**
+ * @brief Portable kernel: one sample at a time, branch-free inner loop.
+ */
+static void insideScalar(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside) {
+    for (int i = 0; i < count; i++) {
+        double px = xs[i], py = ys[i];
+        int s = slabOf(index, py);
+        int parity = 0;
+        for (int e = index->slabStart[s]; e < index->slabStart[s + 1]; e++) {
+            parity ^= (py >= index->edgeYLo[e]) & (py < index->edgeYHi[e]) &
+                      (px < index->edgeX[e] + (py - index->edgeYLo[e]) * index->edgeSlope[e]);
+        }
+        inside[i] = parity;
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+/**
+ * @brief SSE2 kernel: 2 edges of the sample's slab per step.
+ */
+static void insideSse2(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside) {
+    for (int i = 0; i < count; i++) {
+        __m128d px = _mm_set1_pd(xs[i]);
+        __m128d py = _mm_set1_pd(ys[i]);
+        int s = slabOf(index, ys[i]);
+        __m128d parity = _mm_setzero_pd();
+
+        for (int e = index->slabStart[s]; e < index->slabStart[s + 1]; e += 2) {
+            __m128d yLo = _mm_loadu_pd(index->edgeYLo + e);
+            __m128d yHi = _mm_loadu_pd(index->edgeYHi + e);
+            __m128d x = _mm_loadu_pd(index->edgeX + e);
+            __m128d slope = _mm_loadu_pd(index->edgeSlope + e);
+            __m128d cross = _mm_and_pd(_mm_cmpge_pd(py, yLo), _mm_cmplt_pd(py, yHi));
+            cross = _mm_and_pd(cross, _mm_cmplt_pd(px, _mm_add_pd(x, _mm_mul_pd(_mm_sub_pd(py, yLo), slope))));
+            parity = _mm_xor_pd(parity, cross);
+        }
+
+        inside[i] = __builtin_parity(_mm_movemask_pd(parity));
+    }
+}
+
+/**
+ * @brief AVX2 kernel: 4 edges of the sample's slab per step.
+ */
+__attribute__((target("avx2")))
+static void insideAvx2(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside) {
+    for (int i = 0; i < count; i++) {
+        __m256d px = _mm256_set1_pd(xs[i]);
+        __m256d py = _mm256_set1_pd(ys[i]);
+        int s = slabOf(index, ys[i]);
+        __m256d parity = _mm256_setzero_pd();
+
+        for (int e = index->slabStart[s]; e < index->slabStart[s + 1]; e += SLAB_LANES) {
+            __m256d yLo = _mm256_loadu_pd(index->edgeYLo + e);
+            __m256d yHi = _mm256_loadu_pd(index->edgeYHi + e);
+            __m256d x = _mm256_loadu_pd(index->edgeX + e);
+            __m256d slope = _mm256_loadu_pd(index->edgeSlope + e);
+            __m256d cross = _mm256_and_pd(_mm256_cmp_pd(py, yLo, _CMP_GE_OQ), _mm256_cmp_pd(py, yHi, _CMP_LT_OQ));
+            __m256d xCross = _mm256_add_pd(x, _mm256_mul_pd(_mm256_sub_pd(py, yLo), slope));
+            cross = _mm256_and_pd(cross, _mm256_cmp_pd(px, xCross, _CMP_LT_OQ));
+            parity = _mm256_xor_pd(parity, cross);
+        }
+
+        inside[i] = __builtin_parity(_mm256_movemask_pd(parity));
+    }
+}
+
+#endif
+
+/**
+ * @brief Returns the kernel of a kind, or NULL if this build or CPU lacks it.
+ */
+static BatchKernel kernelOfKind(SlabKernel kind) {
+    switch (kind) {
+        case SLAB_KERNEL_SCALAR: return insideScalar;
+#ifdef HAVE_X86_KERNELS
+        case SLAB_KERNEL_SSE2: return insideSse2;
+        case SLAB_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? insideAvx2 : NULL;
+        default: {
+            BatchKernel best = kernelOfKind(SLAB_KERNEL_AVX2);
+            return best != NULL ? best : insideSse2;
+        }
+#else
+        case SLAB_KERNEL_AUTO: return insideScalar;
+        default: return NULL;
+#endif
+    }
+}
+
+/**
+ * @brief Forces the kernel of insideSlabBatch(), e.g. to compare them;
+ * SLAB_KERNEL_AUTO goes back to the fastest one the CPU supports.
+ * @param kind Kernel to use from now on.
+ * @return false (and the kernel is left unchanged) if it is not available here.
+ */
+bool useSlabKernel(SlabKernel kind) {
+    BatchKernel k = kernelOfKind(kind);
+    if (k == NULL) return false;
+    __atomic_store_n(&slabKernel, k, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * @brief Exact crossing-number test of a batch of samples against a slab index.
+ * @param index Slab index built by buildSlabIndex().
+ * @param xs Array of x coordinates.
+ * @param ys Array of y coordinates.
+ * @param count Number of samples.
+ * @param inside Output: 1 for samples inside the polygon, 0 otherwise.
+ * @return Number of samples inside the polygon.
+ */
+int insideSlabBatch(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside) {
+    BatchKernel k = __atomic_load_n(&slabKernel, __ATOMIC_RELAXED);
+    if (k == NULL) {
+        k = kernelOfKind(SLAB_KERNEL_AUTO);
+        __atomic_store_n(&slabKernel, k, __ATOMIC_RELAXED);
+    }
+
+    k(index, xs, ys, count, inside);
+
+    int hits = 0;
+    for (int i = 0; i < count; i++) hits += inside[i];
+    return hits;
+}
+
+/**
+ * @brief Exact test of a batch of samples against a convex polygon.
+ * @param convex Convex polygon.
+ * @param xs Array of x coordinates.
+ * @param ys Array of y coordinates.
+ * @param count Number of samples.
+ * @param inside Output: 1 for samples inside the polygon, 0 otherwise.
+ * @return Number of samples inside the polygon.
+ */
+int insideConvexBatch(const ConvexPolygon *convex, const double *xs, const double *ys, int count, unsigned char *inside) {
+    int hits = 0;
+
+    for (int i = 0; i < count; i++) {
+        Point p = {xs[i], ys[i]};
+        inside[i] = isInsideConvexPolygon(convex, p);
+        hits += inside[i];
+    }
+
+    return hits;
+}
+
+/**
+ * @brief Tests a batch of samples: grid lookup first, then the batch kernel
+ * on the samples that landed in boundary cells.
+ * @param grid Grid built by buildCellGrid().
+ * @param xs Array of x coordinates.
+ * @param ys Array of y coordinates.
+ * @param count Number of samples.
+ * @param inside Optional output (may be NULL): 1 for samples inside, 0 otherwise.
+ * @return Number of samples inside the polygon.
+ */
+int countInsideBatch(const CellGrid *grid, const double *xs, const double *ys, int count, unsigned char *inside) {
+    double boundaryX[BATCH_SIZE], boundaryY[BATCH_SIZE];
+    int where[BATCH_SIZE];
+    unsigned char exact[BATCH_SIZE];
+    int hits = 0;
+
+    for (int base = 0; base < count; base += BATCH_SIZE) {
+        int chunk = count - base < BATCH_SIZE ? count - base : BATCH_SIZE;
+        int boundary = 0;
+
+        for (int i = 0; i < chunk; i++) {
+            Point p = {xs[base + i], ys[base + i]};
+            CellClass c = classifyPoint(grid, p);
+            if (c == CELL_BOUNDARY) {
+                boundaryX[boundary] = p.x;
+                boundaryY[boundary] = p.y;
+                where[boundary++] = base + i;
+            } else {
+                hits += c == CELL_INSIDE;
+                if (inside) inside[base + i] = c == CELL_INSIDE;
+            }
+        }
+
+        hits += grid->convex ? insideConvexBatch(grid->convex, boundaryX, boundaryY, boundary, exact)
+                             : insideSlabBatch(grid->index, boundaryX, boundaryY, boundary, exact);
+        if (inside) {
+            for (int k = 0; k < boundary; k++) inside[where[k]] = exact[k];
+        }
+    }
+
+    return hits;
+}
+
+/**
+ * @brief Tests a batch of samples against every region of a multi-region grid.
+ * @param grid Grid built with several regions.
+ * @param xs Array of x coordinates.
+ * @param ys Array of y coordinates.
+ * @param count Number of samples.
+ * @param inside Optional output (may be NULL): 1 for samples inside some region, 0 otherwise.
+ * @param regionHits Optional array (may be NULL) of one counter per region, incremented per hit.
+ * @param parity Scratch array of one zeroed byte per region; left zeroed.
+ * @param regions Scratch array of one int per region.
+ * @return Number of samples inside some region.
+ */
+int countRegionsBatch(const CellGrid *grid, const double *xs, const double *ys, int count, unsigned char *inside,
+                      long *regionHits, unsigned char *parity, int *regions) {
+    int hits = 0;
+
+    for (int i = 0; i < count; i++) {
+        Point p = {xs[i], ys[i]};
+        CellClass c = classifyPoint(grid, p);
+        int holding = 0;
+
+        if (c == CELL_INSIDE) {
+            regions[0] = grid->cellRegion[cellIndex(grid, p)];
+            holding = 1;
+        } else if (c == CELL_BOUNDARY) {
+            holding = regionsAtPoint(grid->index, p, parity, regions);
+        }
+
+        hits += holding > 0;
+        if (inside) inside[i] = holding > 0;
+        for (int k = 0; regionHits && k < holding; k++) regionHits[regions[k]]++;
+    }
+
+    return hits;
+}
@@ -0,0 +1,40 @@
+#ifndef MC_BATCH_H
+#define MC_BATCH_H
+
+#include <stdbool.h>
+#include "mc_grid.h"
+#include "mc_slab.h"
+
+#define BATCH_SIZE 256
+
+/*
+ * Batch point-in-polygon tests over SoA coordinate arrays.
+ *
+ * insideSlabBatch() runs a branch-free crossing-number test: the edges of
+ * a slab are contiguous and padded to SLAB_LANES, so the AVX2 kernel tests
+ * a sample against 4 edges per step with plain loads and the SSE2 kernel
+ * against 2. A scalar loop is used on other CPUs. The kernel is chosen
+ * once at run time; useSlabKernel() forces one, so they can be compared.
+ *
+ * insideConvexBatch() is the exact test of convex polygons built without
+ * slab index: a branch-free binary search over the fan of the polygon.
+ *
+ * countRegionsBatch() is the version for models with several regions: a
+ * sample counts as inside when some region holds it, and every region
+ * holding it gets a hit, from the same grid lookup and slab pass.
+ */
+typedef enum {
+    SLAB_KERNEL_AUTO,
+    SLAB_KERNEL_SCALAR,
+    SLAB_KERNEL_SSE2,
+    SLAB_KERNEL_AVX2
+} SlabKernel;
+
+bool useSlabKernel(SlabKernel kind);
+int insideSlabBatch(const SlabIndex *index, const double *xs, const double *ys, int count, unsigned char *inside);
+int insideConvexBatch(const ConvexPolygon *convex, const double *xs, const double *ys, int count, unsigned char *inside);
+int countInsideBatch(const CellGrid *grid, const double *xs, const double *ys, int count, unsigned char *inside);
+int countRegionsBatch(const CellGrid *grid, const double *xs, const double *ys, int count, unsigned char *inside,
+                      long *regionHits, unsigned char *parity, int *regions);
+
+#endif
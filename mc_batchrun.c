@@ -0,0 +1,298 @@
+#include <dirent.h>
+#include <glob.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "mc_batchrun.h"
+#include "mc_pool.h"
+
+typedef struct {
+    const char *path;
+    int numPoints;
+    Tally tally;
+    double domainArea;  // area of the sampled domain
+    double knownArea;   // area counted without sampling
+    double exactArea;
+    double seconds;
+    bool ok;
+} PolygonJob;
+
+typedef struct {
+    const EstimatorConfig *config;
+    PolygonJob *jobs;
+    int *order;         // job indices, largest file first
+    int count;
+    atomic_int next;
+    atomic_int done;
+} BatchRun;
+
+typedef struct {
+    char **paths;
+    int count;
+    int capacity;
+} PathList;
+
+/**
+ * @brief Appends a copy of a path to the list.
+ */
+static bool addPath(PathList *list, const char *path) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        char **grown = realloc(list->paths, capacity * sizeof(char *));
+        if (grown == NULL) return false;
+        list->paths = grown;
+        list->capacity = capacity;
+    }
+    list->paths[list->count] = strdup(path);
+    return list->paths[list->count++] != NULL;
+}
+
+static int comparePaths(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/**
+ * @brief Adds the regular files of a directory, sorted by name.
+ */
+static bool addDirectory(PathList *list, const char *dir) {
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        perror(dir);
+        return false;
+    }
+
+    int first = list->count;
+    bool ok = true;
+    struct dirent *entry;
+    char path[4096];
+    while (ok && (entry = readdir(d)) != NULL) {
+        struct stat st;
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) ok = addPath(list, path);
+    }
+    closedir(d);
+
+    qsort(list->paths + first, list->count - first, sizeof(char *), comparePaths);
+    return ok;
+}
+
+/**
+ * @brief Adds the paths listed one per line in a file ("-" for stdin).
+ */
+static bool addListFile(PathList *list, const char *filename) {
+    FILE *in = strcmp(filename, "-") == 0 ? stdin : fopen(filename, "r");
+    if (in == NULL) {
+        perror(filename);
+        return false;
+    }
+
+    bool ok = true;
+    char line[4096];
+    while (ok && fgets(line, sizeof(line), in) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#') ok = addPath(list, line);
+    }
+    if (in != stdin) fclose(in);
+    return ok;
+}
+
+/**
+ * @brief Expands the polygon arguments of a batch into a list of files.
+ *
+ * Each argument is a polygon file, a directory (its regular files), a
+ * quoted glob pattern such as 'poly*.txt', or @list, a file naming
+ * one polygon per line ("@-" reads the list from stdin).
+ * @param argc Number of arguments.
+ * @param argv The arguments.
+ * @param paths Output: malloc'ed array of paths; release it with freePolygonPaths().
+ * @param count Output: number of paths.
+ * @return false if an argument could not be expanded.
+ */
+bool collectPolygonPaths(int argc, char *argv[], char ***paths, int *count) {
+    PathList list = {NULL, 0, 0};
+    bool ok = true;
+
+    for (int i = 0; ok && i < argc; i++) {
+        const char *arg = argv[i];
+        struct stat st;
+
+        if (arg[0] == '@') {
+            ok = addListFile(&list, arg + 1);
+        } else if (stat(arg, &st) == 0) {
+            ok = S_ISDIR(st.st_mode) ? addDirectory(&list, arg) : addPath(&list, arg);
+        } else if (strpbrk(arg, "*?[") != NULL) {
+            glob_t matches;
+            int status = glob(arg, 0, NULL, &matches);
+            for (size_t k = 0; status == 0 && ok && k < matches.gl_pathc; k++) ok = addPath(&list, matches.gl_pathv[k]);
+            if (status == 0) globfree(&matches);
+            else if (status != GLOB_NOMATCH) ok = false;
+        } else {
+            perror(arg);
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        freePolygonPaths(list.paths, list.count);
+        return false;
+    }
+    *paths = list.paths;
+    *count = list.count;
+    return true;
+}
+
+/**
+ * @brief Releases the paths returned by collectPolygonPaths().
+ */
+void freePolygonPaths(char **paths, int count) {
+    for (int i = 0; i < count; i++) free(paths[i]);
+    free(paths);
+}
+
+/**
+ * @brief Seconds elapsed since start, on the monotonic clock.
+ */
+static double secondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Loads and samples one polygon on the calling thread.
+ */
+static void estimatePolygon(const EstimatorConfig *config, PolygonJob *job) {
+    PolygonModel model;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    job->ok = loadPolygonModel(job->path, &model);
+    if (job->ok) {
+        long chunks = chunkCount(config);
+        samplingAreas(&model, config->domain, &job->domainArea, &job->knownArea);
+        for (long c = 0; c < chunks; c++) {
+            Tally t = sampleChunk(&model, config, c, NULL, NULL);
+            job->tally.samples += t.samples;
+            job->tally.hits += t.hits;
+            if (targetReached(&config->rule, job->domainArea, job->knownArea, job->tally.samples, job->tally.hits)) {
+                break;
+            }
+        }
+        job->numPoints = model.numPoints;
+        job->exactArea = model.exactArea;
+        freePolygonModel(&model);
+    }
+    job->seconds = secondsSince(&start);
+}
+
+/**
+ * @brief Pool callback: ignores the chunk number and takes the next polygon
+ * in largest-first order, so the pool's own static split does not matter.
+ */
+static long batchChunk(void *ctx, long chunk, int worker) {
+    BatchRun *run = ctx;
+    (void)chunk, (void)worker;
+
+    int k = atomic_fetch_add(&run->next, 1);
+    if (k >= run->count) return 0;
+    estimatePolygon(run->config, &run->jobs[run->order[k]]);
+
+    int done = atomic_fetch_add(&run->done, 1) + 1;
+    if (run->config->showProgress) {
+        flockfile(stdout);
+        displayProgress(done, run->count);
+        funlockfile(stdout);
+    }
+    return 0;
+}
+
+typedef struct {
+    off_t size;
+    int job;
+} SizeKey;
+
+static int compareSizes(const void *a, const void *b) {
+    const SizeKey *ka = a, *kb = b;
+    return ka->size < kb->size ? 1 : ka->size > kb->size ? -1 : ka->job - kb->job;
+}
+
+/**
+ * @brief Writes the result table of a batch.
+ * @return false if the file could not be written.
+ */
+static bool writeResults(const char *output, const PolygonJob *jobs, int count) {
+    FILE *out = fopen(output, "w");
+    if (out == NULL) {
+        perror(output);
+        return false;
+    }
+
+    fprintf(out, "path\tvertices\tsamples\thits\tdomain_area\tknown_area\testimate\tstd_error\texact_area\tseconds"
+                 "\tstatus\n");
+    for (int i = 0; i < count; i++) {
+        const PolygonJob *job = &jobs[i];
+        double estimate = job->knownArea +
+                          (job->tally.samples > 0 ? job->domainArea * job->tally.hits / job->tally.samples : 0);
+        fprintf(out, "%s\t%d\t%ld\t%ld\t%.17g\t%.17g\t%.17g\t%.6g\t%.17g\t%.6f\t%s\n", job->path, job->numPoints,
+                job->tally.samples, job->tally.hits, job->domainArea, job->knownArea, estimate,
+                job->ok ? areaStdError(job->domainArea, job->tally.samples, job->tally.hits) : 0,
+                job->exactArea, job->seconds, job->ok ? "ok" : "error");
+    }
+
+    bool ok = fclose(out) == 0;
+    if (!ok) perror(output);
+    return ok;
+}
+
+/**
+ * @brief Estimates every polygon of a batch and writes the result table.
+ * @param paths Polygon files.
+ * @param count Number of polygon files.
+ * @param config Budget, seed, sampler and stop rule of each polygon;
+ * workers is the size of the pool (0 = one per core).
+ * @param output Path of the table to write.
+ * @return false if the pool or the table failed or the stop rule cannot be
+ * used with the sampler; polygons that cannot be loaded only get an "error" row.
+ */
+bool runPolygonBatch(char **paths, int count, const EstimatorConfig *config, const char *output) {
+    // O ciclo de pedaços de estimatePolygon() pára na regra: os estratos ficariam por metade
+    if (!stopRuleSupported(config)) return false;
+
+    PolygonJob *jobs = calloc(count, sizeof(PolygonJob));
+    int *order = malloc(count * sizeof(int));
+    SizeKey *keys = malloc(count * sizeof(SizeKey));
+    if (jobs == NULL || order == NULL || keys == NULL) {
+        free(jobs);
+        free(order);
+        free(keys);
+        return false;
+    }
+
+    // O tamanho do ficheiro serve de estimativa do custo de cada polígono
+    for (int i = 0; i < count; i++) {
+        struct stat st;
+        jobs[i].path = paths[i];
+        keys[i].size = stat(paths[i], &st) == 0 ? st.st_size : 0;
+        keys[i].job = i;
+    }
+    qsort(keys, count, sizeof(SizeKey), compareSizes);
+    for (int i = 0; i < count; i++) order[i] = keys[i].job;
+    free(keys);
+
+    BatchRun run = {config, jobs, order, count, 0, 0};
+    int workers = config->workers > 0 ? config->workers : defaultWorkerCount();
+    if (workers > count) workers = count;
+
+    bool ok = count == 0 || runWorkPool(workers, count, batchChunk, &run, NULL);
+    if (config->showProgress && count > 0) printf("\n");
+    if (!ok) fprintf(stderr, "Failed to start the worker threads\n");
+
+    ok = ok && writeResults(output, jobs, count);
+    free(jobs);
+    free(order);
+    return ok;
+}
@@ -0,0 +1,28 @@
+#ifndef MC_BATCHRUN_H
+#define MC_BATCHRUN_H
+
+#include <stdbool.h>
+#include "mc_estimator.h"
+
+/*
+ * Batch mode: one estimation per polygon file over a single pool of
+ * threads.
+ *
+ * Polygons are sorted by file size, largest first, and every thread takes
+ * the next polygon from a shared counter when it finishes the previous one
+ * (longest-processing-time scheduling), so a big polygon never starts last
+ * and leaves the other threads idle. Each polygon is loaded (through the
+ * polygon cache), sampled in chunks by one thread with the run's budget,
+ * seed and sampler, and released. An active stop rule is checked after
+ * every chunk, per polygon.
+ *
+ * The result is a tab-separated table with a header row and one row per
+ * polygon, in input order: path, vertices, samples, hits, domain_area,
+ * known_area, estimate, std_error, exact_area, seconds and status ("ok" or
+ * "error"). estimate is known_area + domain_area * hits / samples.
+ */
+bool collectPolygonPaths(int argc, char *argv[], char ***paths, int *count);
+void freePolygonPaths(char **paths, int count);
+bool runPolygonBatch(char **paths, int count, const EstimatorConfig *config, const char *output);
+
+#endif
@@ -0,0 +1,225 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_checkpoint.h"
+
+/**
+ * @brief Samples of a chunk: CHUNK_POINTS, or what is left of the budget for the last one.
+ */
+static long chunkSamples(const Checkpoint *checkpoint, long chunk) {
+    long first = chunk * CHUNK_POINTS;
+    long total = checkpoint->header.totalPoints;
+    return total - first < CHUNK_POINTS ? total - first : CHUNK_POINTS;
+}
+
+/**
+ * @brief Tells whether a saved header describes the same run as ours.
+ */
+static bool sameRun(const CheckpointHeader *saved, const CheckpointHeader *run) {
+    return memcmp(saved->magic, CHECKPOINT_MAGIC, 8) == 0 &&
+           saved->seed == run->seed && saved->totalPoints == run->totalPoints &&
+           saved->chunkPoints == run->chunkPoints && saved->sampler == run->sampler &&
+           saved->domain == run->domain && saved->numPoints == run->numPoints &&
+           saved->numRegions == run->numRegions && saved->exactArea == run->exactArea &&
+           memcmp(&saved->box, &run->box, sizeof(BoundingBox)) == 0 && saved->chunks == run->chunks;
+}
+
+/**
+ * @brief Marks the finished chunks of a checkpoint file as restored.
+ * @return false if the file exists but cannot be resumed.
+ */
+static bool restoreCheckpoint(Checkpoint *checkpoint) {
+    FILE *in = fopen(checkpoint->path, "rb");
+    if (in == NULL) {
+        if (errno != ENOENT) {
+            perror(checkpoint->path);
+            return false;
+        }
+        fprintf(stderr, "No checkpoint at %s, starting from the first point\n", checkpoint->path);
+        return true;
+    }
+
+    CheckpointHeader saved;
+    size_t bitmapBytes = (checkpoint->chunks + 7) / 8;
+    unsigned char *bitmap = malloc(bitmapBytes);
+    bool ok = bitmap != NULL && fread(&saved, sizeof(saved), 1, in) == 1 && sameRun(&saved, &checkpoint->header) &&
+              fread(bitmap, 1, bitmapBytes, in) == bitmapBytes;
+    fclose(in);
+    if (!ok) {
+        fprintf(stderr, "%s is not a checkpoint of this run (polygon, points, seed, sampler and domain must match)\n",
+                checkpoint->path);
+        free(bitmap);
+        return false;
+    }
+
+    // Os pedaços acabados não são repetidos: os totais guardados somam-se no fim
+    for (long c = 0; c < checkpoint->chunks; c++) {
+        if (bitmap[c / 8] & (1 << (c % 8))) {
+            atomic_store_explicit(&checkpoint->chunkHits[c], CHUNK_RESTORED, memory_order_relaxed);
+            checkpoint->restoredChunks++;
+        }
+    }
+    checkpoint->restoredSamples = saved.samples;
+    checkpoint->restoredHits = saved.hits;
+    free(bitmap);
+    return true;
+}
+
+/**
+ * @brief Prepares the checkpoint of a run and, with config->resume, loads its last snapshot.
+ * @param checkpoint Checkpoint to initialize.
+ * @param model Polygon of the run.
+ * @param config Configuration of the run (checkpointPath set).
+ * @return false if the shared state cannot be allocated or the snapshot belongs to another run.
+ */
+bool openCheckpoint(Checkpoint *checkpoint, const PolygonModel *model, const EstimatorConfig *config) {
+    memset(checkpoint, 0, sizeof(*checkpoint));
+    checkpoint->path = config->checkpointPath;
+    checkpoint->interval = config->checkpointInterval > 0 ? config->checkpointInterval : DEFAULT_CHECKPOINT_INTERVAL;
+    checkpoint->chunks = chunkCount(config);
+
+    CheckpointHeader *h = &checkpoint->header;
+    memcpy(h->magic, CHECKPOINT_MAGIC, 8);
+    h->seed = config->seed;
+    h->totalPoints = config->totalPoints;
+    h->chunkPoints = CHUNK_POINTS;
+    h->sampler = config->sampler;
+    h->domain = config->domain;
+    h->numPoints = model->numPoints;
+    h->numRegions = model->numRegions;
+    h->box = model->grid.box;
+    h->exactArea = model->exactArea;
+    h->chunks = checkpoint->chunks;
+
+    // Memória partilhada criada antes do fork: threads e filhos escrevem no mesmo vetor
+    size_t bytes = checkpoint->chunks * sizeof(atomic_int);
+    checkpoint->chunkHits = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (checkpoint->chunkHits == MAP_FAILED) {
+        perror("mmap");
+        checkpoint->chunkHits = NULL;
+        return false;
+    }
+    for (long c = 0; c < checkpoint->chunks; c++) atomic_init(&checkpoint->chunkHits[c], CHUNK_PENDING);
+
+    if (config->resume && !restoreCheckpoint(checkpoint)) {
+        munmap(checkpoint->chunkHits, bytes);
+        checkpoint->chunkHits = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a snapshot of the finished chunks, replacing the previous one atomically.
+ * @param checkpoint Checkpoint of the run.
+ * @return false if the snapshot could not be written; the previous one is then kept.
+ */
+bool saveCheckpoint(Checkpoint *checkpoint) {
+    CheckpointHeader h = checkpoint->header;
+    size_t bitmapBytes = (checkpoint->chunks + 7) / 8;
+    unsigned char *bitmap = calloc(bitmapBytes > 0 ? bitmapBytes : 1, 1);
+    if (bitmap == NULL) return false;
+
+    h.doneChunks = checkpoint->restoredChunks;
+    h.samples = checkpoint->restoredSamples;
+    h.hits = checkpoint->restoredHits;
+    for (long c = 0; c < checkpoint->chunks; c++) {
+        int hits = atomic_load_explicit(&checkpoint->chunkHits[c], memory_order_relaxed);
+        if (hits == CHUNK_PENDING) continue;
+        bitmap[c / 8] |= 1 << (c % 8);
+        if (hits == CHUNK_RESTORED) continue;
+        h.doneChunks++;
+        h.samples += chunkSamples(checkpoint, c);
+        h.hits += hits;
+    }
+
+    // Ficheiro temporário + rename: um processo morto a meio deixa o anterior intacto
+    char temporary[4096];
+    snprintf(temporary, sizeof(temporary), "%s.%d.tmp", checkpoint->path, (int)getpid());
+    FILE *out = fopen(temporary, "wb");
+    bool ok = out != NULL && fwrite(&h, sizeof(h), 1, out) == 1 &&
+              fwrite(bitmap, 1, bitmapBytes, out) == bitmapBytes && fflush(out) == 0 && fsync(fileno(out)) == 0;
+    if (out != NULL && fclose(out) != 0) ok = false;
+    ok = ok && rename(temporary, checkpoint->path) == 0;
+    if (!ok) {
+        perror(checkpoint->path);
+        unlink(temporary);
+    }
+
+    free(bitmap);
+    return ok;
+}
+
+/**
+ * @brief Saver thread: writes a snapshot every interval until the run ends.
+ */
+static void *saveEveryInterval(void *arg) {
+    Checkpoint *checkpoint = arg;
+
+    pthread_mutex_lock(&checkpoint->lock);
+    while (!checkpoint->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t)checkpoint->interval;
+        deadline.tv_nsec += (long)((checkpoint->interval - (time_t)checkpoint->interval) * 1e9);
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        int rc = 0;
+        while (!checkpoint->stopping && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&checkpoint->wake, &checkpoint->lock, &deadline);
+        }
+        if (checkpoint->stopping) break;
+
+        pthread_mutex_unlock(&checkpoint->lock);
+        saveCheckpoint(checkpoint);
+        pthread_mutex_lock(&checkpoint->lock);
+    }
+    pthread_mutex_unlock(&checkpoint->lock);
+    return NULL;
+}
+
+/**
+ * @brief Starts the thread that saves a snapshot every checkpoint->interval seconds.
+ * @return false if the thread could not be created.
+ */
+bool startCheckpointSaver(Checkpoint *checkpoint) {
+    pthread_mutex_init(&checkpoint->lock, NULL);
+    pthread_cond_init(&checkpoint->wake, NULL);
+    checkpoint->started = pthread_create(&checkpoint->saver, NULL, saveEveryInterval, checkpoint) == 0;
+    if (!checkpoint->started) {
+        pthread_mutex_destroy(&checkpoint->lock);
+        pthread_cond_destroy(&checkpoint->wake);
+    }
+    return checkpoint->started;
+}
+
+/**
+ * @brief Stops the saver thread, writes the final snapshot and frees the shared state.
+ * @return false if the final snapshot could not be written.
+ */
+bool closeCheckpoint(Checkpoint *checkpoint) {
+    if (checkpoint->chunkHits == NULL) return true;
+
+    if (checkpoint->started) {
+        pthread_mutex_lock(&checkpoint->lock);
+        checkpoint->stopping = true;
+        pthread_cond_signal(&checkpoint->wake);
+        pthread_mutex_unlock(&checkpoint->lock);
+        pthread_join(checkpoint->saver, NULL);
+        pthread_mutex_destroy(&checkpoint->lock);
+        pthread_cond_destroy(&checkpoint->wake);
+        checkpoint->started = false;
+    }
+
+    bool ok = saveCheckpoint(checkpoint);
+    munmap(checkpoint->chunkHits, checkpoint->chunks * sizeof(atomic_int));
+    checkpoint->chunkHits = NULL;
+    return ok;
+}
@@ -0,0 +1,91 @@
+#ifndef MC_CHECKPOINT_H
+#define MC_CHECKPOINT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "mc_estimator.h"
+
+#define CHECKPOINT_MAGIC "MCCKPT01"
+#define DEFAULT_CHECKPOINT_INTERVAL 10.0   // seconds between two snapshots
+#define CHUNK_PENDING (-1)                  // chunkHits of a chunk not finished yet
+#define CHUNK_RESTORED (-2)                 // chunkHits of a chunk finished before the resume
+
+/*
+ * Periodic checkpoint of a long estimation, and its resumption.
+ *
+ * The state of a worker is fully described by the chunks it finished: chunk
+ * c always draws its points from PRNG substream c (mc_estimator.h), so the
+ * PRNG position of a finished chunk needs no saving and an unfinished one
+ * restarts from its first point. Workers record the hits of every full chunk
+ * in a per-chunk array in anonymous shared memory, visible to threads and to
+ * forked children alike; a saver thread in the parent snapshots it every
+ * interval into a small file:
+ *  - a CheckpointHeader that fingerprints the run (seed, budget, sampler,
+ *    domain, polygon) and totals the finished chunks;
+ *  - a bitmap of the finished chunks.
+ * The file is written to a temporary name, flushed and renamed into place,
+ * so a run killed at any moment leaves the previous snapshot intact.
+ *
+ * On resume the finished chunks are skipped and their saved totals added to
+ * the new ones. Chunks do not depend on the worker count, so a run may be
+ * resumed with another number of workers or another backend and still ends
+ * with exactly the samples and hits of an uninterrupted run.
+ */
+typedef struct {
+    char magic[8];
+    uint64_t seed;
+    int64_t totalPoints;
+    int64_t chunkPoints;
+    uint32_t sampler;
+    uint32_t domain;
+    int32_t numPoints;      // polygon fingerprint: vertices, box and shoelace area
+    int32_t numRegions;
+    BoundingBox box;
+    double exactArea;
+    int64_t chunks;
+    int64_t doneChunks;
+    int64_t samples;        // totals of the finished chunks
+    int64_t hits;
+} CheckpointHeader;
+
+struct Checkpoint {
+    const char *path;
+    double interval;
+    CheckpointHeader header;    // fingerprint of the run
+    long chunks;
+    atomic_int *chunkHits;      // shared: hits of each finished chunk, CHUNK_PENDING otherwise
+    long restoredChunks;        // finished chunks loaded from the file
+    long restoredSamples;
+    long restoredHits;
+    pthread_t saver;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stopping;
+    bool started;
+};
+
+bool openCheckpoint(Checkpoint *checkpoint, const PolygonModel *model, const EstimatorConfig *config);
+bool saveCheckpoint(Checkpoint *checkpoint);
+bool startCheckpointSaver(Checkpoint *checkpoint);
+bool closeCheckpoint(Checkpoint *checkpoint);
+
+/**
+ * @brief Tells whether a chunk was finished, in this run or in the resumed one.
+ */
+static inline bool chunkDone(const Checkpoint *checkpoint, long chunk) {
+    return atomic_load_explicit(&checkpoint->chunkHits[chunk], memory_order_relaxed) != CHUNK_PENDING;
+}
+
+/**
+ * @brief Records a finished chunk. Only the worker that sampled it may call this.
+ * @param checkpoint Checkpoint of the run.
+ * @param chunk Chunk number.
+ * @param hits Number of the chunk's points inside the polygon.
+ */
+static inline void recordChunk(Checkpoint *checkpoint, long chunk, long hits) {
+    atomic_store_explicit(&checkpoint->chunkHits[chunk], (int)hits, memory_order_relaxed);
+}
+
+#endif
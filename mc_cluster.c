@@ -0,0 +1,596 @@
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_checkpoint.h"
+#include "mc_cluster.h"
+#include "mc_pool.h"
+
+#define IO_TIMEOUT_S 5          // bound on a single message once it started arriving, and on the wait for a HELLO
+#define POLL_INTERVAL_MS 100
+
+typedef struct {
+    int fd;
+    int id;
+    int threads;        // 0 until its HELLO arrived
+    long first;         // unit [first, first + count) being sampled
+    long count;         // 0 while idle
+    long reported;      // RESULTs received for the unit
+    double lastHeard;   // when the worker connected, last sent a message or got its unit
+} ClusterWorker;
+
+typedef struct {
+    long first;
+    long count;
+} ChunkRange;
+
+typedef struct {
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    double workerTimeout;
+    double domainArea;
+    double knownArea;
+    long chunks;
+    unsigned char *done;        // one flag per chunk, set on its first RESULT
+    long doneChunks;
+    long nextChunk;             // chunks from here on were never assigned
+    ChunkRange *requeued;       // units of lost workers, taken before nextChunk
+    int numRequeued;
+    ClusterWorker *workers;
+    int numWorkers;
+    int joined;                 // workers that received the job
+    Tally tally;
+    Checkpoint *checkpoint;
+} Coordinator;
+
+/**
+ * @brief Seconds on the monotonic clock.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Samples of a chunk: CHUNK_POINTS, or what is left of the budget for the last one.
+ */
+static long chunkSamples(const EstimatorConfig *config, long chunk) {
+    long first = chunk * CHUNK_POINTS;
+    return config->totalPoints - first < CHUNK_POINTS ? config->totalPoints - first : CHUNK_POINTS;
+}
+
+/**
+ * @brief Tunes a TCP connection: no Nagle delay for the small records, keepalive
+ * so a vanished peer is eventually noticed, and optionally bounded reads and writes.
+ */
+static void tuneConnection(int fd, bool bounded) {
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+    if (bounded) {
+        struct timeval timeout = {IO_TIMEOUT_S, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+}
+
+/**
+ * @brief Sends one message.
+ */
+static bool sendMessage(int fd, uint32_t type, long chunk, long count, long samples, long hits) {
+    ClusterMessage message = {CLUSTER_MAGIC, type, chunk, count, samples, hits};
+    return writen(fd, &message, sizeof(message)) == (ssize_t)sizeof(message);
+}
+
+/**
+ * @brief Receives one message and checks its magic.
+ */
+static bool receiveMessage(int fd, ClusterMessage *message) {
+    return readn(fd, message, sizeof(*message)) == (ssize_t)sizeof(*message) && message->magic == CLUSTER_MAGIC;
+}
+
+/**
+ * @brief Listens for workers on a TCP port, on every local address.
+ * @return The listening socket, or -1.
+ */
+static int listenOnPort(const char *port) {
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = AI_PASSIVE};
+    struct addrinfo *addresses;
+    char *end;
+    long number = strtol(port, &end, 10);
+    if (*end == '\0' && (number < 1 || number > 65535)) {
+        fprintf(stderr, "Bad port %s\n", port);
+        return -1;
+    }
+
+    int rc = getaddrinfo(NULL, port, &hints, &addresses);
+    if (rc != 0) {
+        fprintf(stderr, "Bad port %s: %s\n", port, gai_strerror(rc));
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *a = addresses; a != NULL && fd == -1; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd == -1) continue;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, a->ai_addr, a->ai_addrlen) == -1 || listen(fd, SOMAXCONN) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    if (fd == -1) perror("Failed to bind or listen on the port");
+    return fd;
+}
+
+/**
+ * @brief Connects to the coordinator, trying each of its addresses.
+ * @return The connected socket, or -1.
+ */
+static int connectTo(const char *host, const char *port) {
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo *addresses;
+    if (getaddrinfo(host, port, &hints, &addresses) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *a = addresses; a != NULL && fd == -1; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd != -1 && connect(fd, a->ai_addr, a->ai_addrlen) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    return fd;
+}
+
+/**
+ * @brief Takes the next unit of at most maxCount consecutive unfinished
+ * chunks, from the units of lost workers first.
+ * @return false when every chunk is finished or assigned.
+ */
+static bool nextUnit(Coordinator *c, long maxCount, long *first, long *count) {
+    while (c->numRequeued > 0) {
+        ChunkRange *r = &c->requeued[c->numRequeued - 1];
+        while (r->count > 0 && c->done[r->first]) {
+            r->first++;
+            r->count--;
+        }
+        if (r->count == 0) {
+            c->numRequeued--;
+            continue;
+        }
+        *first = r->first;
+        for (*count = 0; *count < maxCount && *count < r->count && !c->done[r->first + *count]; (*count)++) {}
+        r->first += *count;
+        r->count -= *count;
+        return true;
+    }
+
+    while (c->nextChunk < c->chunks && c->done[c->nextChunk]) c->nextChunk++;
+    if (c->nextChunk >= c->chunks) return false;
+    *first = c->nextChunk;
+    for (*count = 0; *count < maxCount && c->nextChunk < c->chunks && !c->done[c->nextChunk]; (*count)++) {
+        c->nextChunk++;
+    }
+    return true;
+}
+
+/**
+ * @brief Closes a worker's connection and puts its unfinished chunks back in the queue.
+ */
+static void dropWorker(Coordinator *c, int w, const char *reason) {
+    ClusterWorker *worker = &c->workers[w];
+    long pending = 0;
+
+    for (long k = worker->first; k < worker->first + worker->count; k++) pending += !c->done[k];
+    if (pending > 0) {
+        // A unidade volta inteira à fila; nextUnit() salta os pedaços já recebidos
+        ChunkRange *grown = realloc(c->requeued, (c->numRequeued + 1) * sizeof(ChunkRange));
+        if (grown != NULL) {
+            c->requeued = grown;
+            c->requeued[c->numRequeued++] = (ChunkRange){worker->first, worker->count};
+        }
+    }
+    if (worker->threads == 0) {
+        fprintf(stderr, "Refused a worker: %s before its greeting\n", reason);
+    } else {
+        fprintf(stderr, "Worker %d %s; %ld chunks go back to the queue\n", worker->id, reason, pending);
+    }
+
+    close(worker->fd);
+    c->workers[w] = c->workers[--c->numWorkers];
+}
+
+/**
+ * @brief Sends the job to a new worker: parameters, then the rings of the polygon.
+ */
+static bool sendJob(const Coordinator *c, int fd) {
+    const PolygonModel *model = c->model;
+    const EstimatorConfig *config = c->config;
+    ClusterJob job = {config->seed, config->totalPoints, config->throttle, config->sampler, config->domain,
+                      model->numPoints, model->numRings, model->numRegions, 0};
+    size_t pointBytes = (size_t)model->numPoints * sizeof(Point);
+    size_t startBytes = (size_t)(model->numRings + 1) * sizeof(int32_t);
+    size_t regionBytes = (size_t)model->numRings * sizeof(int32_t);
+
+    return sendMessage(fd, CLUSTER_JOB, 0, 0, 0, 0) &&
+           writen(fd, &job, sizeof(job)) == (ssize_t)sizeof(job) &&
+           writen(fd, model->points, pointBytes) == (ssize_t)pointBytes &&
+           writen(fd, model->ringStart, startBytes) == (ssize_t)startBytes &&
+           writen(fd, model->ringRegion, regionBytes) == (ssize_t)regionBytes;
+}
+
+/**
+ * @brief Accepts a connection. It joins the poll set and waits there for its
+ * HELLO, so a slow or silent peer never holds up the other workers.
+ */
+static void acceptWorker(Coordinator *c, int listenfd) {
+    int fd = accept(listenfd, NULL, NULL);
+    if (fd == -1) return;
+    tuneConnection(fd, true);
+
+    ClusterWorker *grown = realloc(c->workers, (c->numWorkers + 1) * sizeof(ClusterWorker));
+    if (grown == NULL) {
+        fprintf(stderr, "Refused a worker: out of memory\n");
+        close(fd);
+        return;
+    }
+    c->workers = grown;
+    c->workers[c->numWorkers++] = (ClusterWorker){fd, -1, 0, 0, 0, 0, now()};
+}
+
+/**
+ * @brief Registers a connection whose HELLO arrived and sends it the job.
+ * @return false on a bad greeting or a lost connection.
+ */
+static bool registerWorker(Coordinator *c, ClusterWorker *worker) {
+    ClusterMessage hello;
+    if (!receiveMessage(worker->fd, &hello) || hello.type != CLUSTER_HELLO || hello.count <= 0 ||
+        hello.count > INT_MAX || !sendJob(c, worker->fd)) {
+        return false;
+    }
+
+    worker->id = c->joined++;
+    worker->threads = (int)hello.count;
+    worker->lastHeard = now();
+    fprintf(stderr, "Worker %d joined with %d threads\n", worker->id, worker->threads);
+    return true;
+}
+
+/**
+ * @brief Gives a unit to every idle worker while unassigned chunks remain.
+ */
+static void assignIdleWorkers(Coordinator *c) {
+    for (int w = 0; w < c->numWorkers; w++) {
+        ClusterWorker *worker = &c->workers[w];
+        if (worker->threads == 0 || worker->count > 0 || !nextUnit(c, (long)worker->threads * UNIT_CHUNKS_PER_THREAD, &worker->first,
+                                           &worker->count)) {
+            continue;
+        }
+        worker->reported = 0;
+        worker->lastHeard = now();
+        if (!sendMessage(worker->fd, CLUSTER_ASSIGN, worker->first, worker->count, 0, 0)) {
+            dropWorker(c, w--, "could not be reached");
+        }
+    }
+}
+
+/**
+ * @brief Handles one message of a worker.
+ * @return false if the worker broke the protocol or closed its connection.
+ */
+static bool handleMessage(Coordinator *c, ClusterWorker *worker) {
+    ClusterMessage m;
+    if (!receiveMessage(worker->fd, &m) || m.type != CLUSTER_RESULT || m.chunk < 0 || m.chunk >= c->chunks ||
+        m.samples != chunkSamples(c->config, m.chunk) || m.hits < 0 || m.hits > m.samples) {
+        return false;
+    }
+    worker->lastHeard = now();
+
+    // Um pedaço conta uma só vez, mesmo se um trabalhador dado como morto responder depois
+    if (!c->done[m.chunk]) {
+        c->done[m.chunk] = 1;
+        c->doneChunks++;
+        c->tally.samples += m.samples;
+        c->tally.hits += m.hits;
+        if (c->checkpoint) recordChunk(c->checkpoint, m.chunk, m.hits);
+    }
+    if (m.chunk >= worker->first && m.chunk < worker->first + worker->count && ++worker->reported == worker->count) {
+        worker->count = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Event loop of the coordinator: accepts workers, collects results,
+ * reassigns the units of dead workers, until every chunk is counted or the
+ * stop rule is met.
+ */
+static void coordinate(Coordinator *c, int listenfd) {
+    const EstimatorConfig *config = c->config;
+    int previousProgress = -1;
+
+    while (c->doneChunks < c->chunks &&
+           !targetReached(&config->rule, c->domainArea, c->knownArea, c->tally.samples, c->tally.hits)) {
+        struct pollfd *fds = malloc((c->numWorkers + 1) * sizeof(struct pollfd));
+        if (fds == NULL) break;
+        int watched = c->numWorkers;
+        fds[0] = (struct pollfd){listenfd, POLLIN, 0};
+        for (int w = 0; w < watched; w++) fds[w + 1] = (struct pollfd){c->workers[w].fd, POLLIN, 0};
+
+        if (poll(fds, watched + 1, POLL_INTERVAL_MS) > 0) {
+            // De trás para a frente: dropWorker() move o último trabalhador para o lugar livre
+            for (int w = watched - 1; w >= 0; w--) {
+                ClusterWorker *worker = &c->workers[w];
+                if (fds[w + 1].revents != 0 &&
+                    !(worker->threads == 0 ? registerWorker(c, worker) : handleMessage(c, worker))) {
+                    dropWorker(c, w, "left or broke the protocol");
+                }
+            }
+            if (fds[0].revents & POLLIN) acceptWorker(c, listenfd);
+        }
+        free(fds);
+
+        double t = now();
+        for (int w = c->numWorkers - 1; w >= 0; w--) {
+            ClusterWorker *worker = &c->workers[w];
+            if (worker->threads == 0 && t - worker->lastHeard > IO_TIMEOUT_S) {
+                dropWorker(c, w, "stayed silent");
+            } else if (worker->count > 0 && t - worker->lastHeard > c->workerTimeout) {
+                dropWorker(c, w, "timed out");
+            }
+        }
+        assignIdleWorkers(c);
+
+        int progress = (double)c->tally.samples / config->totalPoints * 100;
+        if (config->showProgress && progress != previousProgress) {
+            displayProgress(c->tally.samples, config->totalPoints);
+            previousProgress = progress;
+        }
+    }
+
+    if (config->showProgress) {
+        displayProgress(c->tally.samples, config->totalPoints);
+        printf("\n");
+    }
+    for (int w = 0; w < c->numWorkers; w++) {
+        if (c->workers[w].threads > 0) sendMessage(c->workers[w].fd, CLUSTER_FINISH, 0, 0, 0, 0);
+        close(c->workers[w].fd);
+    }
+    c->numWorkers = 0;
+}
+
+/**
+ * @brief Runs a distributed estimation: serves chunks to the workers that
+ * connect to port until the whole run is counted.
+ * @param port TCP port to listen on.
+ * @param filename Polygon file.
+ * @param config Points, seed, sampler, domain, stop rule and checkpoint of
+ * the run; the workers replace the backend and workers.
+ * @param workerTimeout Seconds a worker holding a unit may stay silent before it is presumed dead.
+ * @param estimate Output: the tally and the area estimate.
+ * @param workers Output: number of workers that joined the run.
+ * @return false if the run could not be set up.
+ */
+bool runCoordinator(const char *port, const char *filename, const EstimatorConfig *config, double workerTimeout,
+                    Estimate *estimate, int *workers) {
+    PolygonModel model;
+    memset(estimate, 0, sizeof(*estimate));
+    if (config->totalPoints <= 0) {
+        fprintf(stderr, "The number of points must be positive\n");
+        return false;
+    }
+    if (config->checkpointPath != NULL && stopRuleActive(&config->rule)) {
+        fprintf(stderr, "Checkpoints need a fixed number of points, not a stop rule\n");
+        return false;
+    }
+    // As unidades distribuídas param na regra como os outros caminhos: os estratos ficariam por metade
+    if (!stopRuleSupported(config) || !loadPolygonModel(filename, &model)) return false;
+
+    Coordinator c = {.model = &model, .config = config, .workerTimeout = workerTimeout};
+    c.chunks = chunkCount(config);
+    c.done = calloc(c.chunks, 1);
+    samplingAreas(&model, config->domain, &c.domainArea, &c.knownArea);
+
+    Checkpoint checkpoint;
+    bool ok = c.done != NULL && (config->checkpointPath == NULL || openCheckpoint(&checkpoint, &model, config));
+    if (ok && config->checkpointPath != NULL) {
+        c.checkpoint = &checkpoint;
+        for (long k = 0; k < c.chunks; k++) c.done[k] = chunkDone(&checkpoint, k);
+        c.doneChunks = checkpoint.restoredChunks;
+        c.tally.samples = checkpoint.restoredSamples;
+        c.tally.hits = checkpoint.restoredHits;
+        if (checkpoint.restoredChunks > 0) {
+            fprintf(stderr, "Resuming from %s: %ld of %ld chunks already done\n", checkpoint.path,
+                    checkpoint.restoredChunks, checkpoint.chunks);
+        }
+        if (!startCheckpointSaver(&checkpoint)) fprintf(stderr, "Failed to start the checkpoint thread\n");
+    }
+
+    // Um trabalhador que desaparece não pode matar o coordenador com SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+    int listenfd = ok ? listenOnPort(port) : -1;
+    if (listenfd != -1) {
+        printf("Coordinator listening on port %s: %ld chunks to hand out\n", port, c.chunks - c.doneChunks);
+        fflush(stdout);
+        coordinate(&c, listenfd);
+        close(listenfd);
+    }
+    ok = listenfd != -1;
+
+    if (c.checkpoint != NULL && !closeCheckpoint(&checkpoint)) ok = false;
+    estimate->tally = c.tally;
+    estimate->domainArea = c.domainArea;
+    estimate->knownArea = c.knownArea;
+    estimate->area = c.knownArea + (c.tally.samples > 0 ? c.domainArea * c.tally.hits / c.tally.samples : 0);
+    *workers = c.joined;
+
+    free(c.done);
+    free(c.requeued);
+    free(c.workers);
+    freePolygonModel(&model);
+    return ok;
+}
+
+/*
+ * A unit being sampled by the worker's thread pool; each thread sends the
+ * RESULT of its chunk as soon as it is done.
+ */
+typedef struct {
+    int fd;
+    pthread_mutex_t lock;   // one writer at a time on the connection
+    const PolygonModel *model;
+    const EstimatorConfig *config;
+    long first;
+    atomic_bool failed;
+} UnitRun;
+
+/**
+ * @brief Samples one chunk of the unit and reports it; run by the worker pool.
+ */
+static long sampleUnitChunk(void *ctx, long chunk, int worker) {
+    UnitRun *run = ctx;
+    (void)worker;
+    if (atomic_load_explicit(&run->failed, memory_order_relaxed)) return 0;
+
+    Tally tally = sampleChunk(run->model, run->config, run->first + chunk, NULL, NULL);
+    pthread_mutex_lock(&run->lock);
+    bool sent = sendMessage(run->fd, CLUSTER_RESULT, run->first + chunk, 0, tally.samples, tally.hits);
+    pthread_mutex_unlock(&run->lock);
+    if (!sent) atomic_store(&run->failed, true);
+    return tally.hits;
+}
+
+/**
+ * @brief Reads a job and builds its polygon model.
+ * @return false on a read error or a malformed job.
+ */
+static bool receiveJob(int fd, EstimatorConfig *config, PolygonModel *model) {
+    ClusterJob job;
+    if (readn(fd, &job, sizeof(job)) != (ssize_t)sizeof(job) || job.totalPoints <= 0 || job.throttle < 0 ||
+        job.sampler > SAMPLER_SOBOL || job.domain > DOMAIN_CELLS || job.numRings < 1 || job.numRegions < 1 ||
+        job.numPoints < 3 * job.numRings) {
+        return false;
+    }
+
+    Point *points = malloc((size_t)job.numPoints * sizeof(Point));
+    int *ringStart = malloc((size_t)(job.numRings + 1) * sizeof(int));
+    int *ringRegion = malloc((size_t)job.numRings * sizeof(int));
+    size_t pointBytes = (size_t)job.numPoints * sizeof(Point);
+    size_t startBytes = (size_t)(job.numRings + 1) * sizeof(int);
+    size_t regionBytes = (size_t)job.numRings * sizeof(int);
+    bool ok = points != NULL && ringStart != NULL && ringRegion != NULL &&
+              readn(fd, points, pointBytes) == (ssize_t)pointBytes &&
+              readn(fd, ringStart, startBytes) == (ssize_t)startBytes &&
+              readn(fd, ringRegion, regionBytes) == (ssize_t)regionBytes &&
+              ringStart[0] == 0 && ringStart[job.numRings] == job.numPoints;
+    for (int r = 0; ok && r < job.numRings; r++) {
+        ok = ringStart[r + 1] - ringStart[r] >= 3 && ringRegion[r] >= 0 && ringRegion[r] < job.numRegions;
+    }
+    if (!ok) {
+        free(points);
+        free(ringStart);
+        free(ringRegion);
+        return false;
+    }
+
+    config->totalPoints = job.totalPoints;
+    config->seed = job.seed;
+    config->throttle = job.throttle;
+    config->sampler = (SamplerKind)job.sampler;
+    config->domain = (DomainKind)job.domain;
+    return buildRegionsModel(points, ringStart, ringRegion, job.numRings, job.numRegions, model);
+}
+
+/**
+ * @brief Serves one job of a coordinator over a connected socket.
+ * @return false if the job or the connection failed before FINISH.
+ */
+static bool serveCoordinator(int fd, int threads) {
+    EstimatorConfig config;
+    PolygonModel model;
+    ClusterMessage m;
+
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.workers = threads;
+    if (!sendMessage(fd, CLUSTER_HELLO, 0, threads, 0, 0) || !receiveMessage(fd, &m) || m.type != CLUSTER_JOB ||
+        !receiveJob(fd, &config, &model)) {
+        fprintf(stderr, "The coordinator sent no valid job\n");
+        return false;
+    }
+    printf("Joined a job of %ld points on a polygon of %d vertices\n", config.totalPoints, model.numPoints);
+    fflush(stdout);
+
+    bool finished = false;
+    long chunks = chunkCount(&config);
+    while (receiveMessage(fd, &m)) {
+        if (m.type == CLUSTER_FINISH) {
+            finished = true;
+            break;
+        }
+        if (m.type != CLUSTER_ASSIGN || m.chunk < 0 || m.count <= 0 || m.chunk + m.count > chunks) break;
+
+        UnitRun run = {fd, PTHREAD_MUTEX_INITIALIZER, &model, &config, m.chunk, false};
+        bool ok = runWorkPool(threads, m.count, sampleUnitChunk, &run, NULL);
+        pthread_mutex_destroy(&run.lock);
+        if (!ok) break;
+        if (atomic_load(&run.failed)) {
+            // Regra de paragem cumprida: o FINISH pode já estar à espera na ligação
+            finished = receiveMessage(fd, &m) && m.type == CLUSTER_FINISH;
+            break;
+        }
+    }
+
+    freePolygonModel(&model);
+    if (!finished) fprintf(stderr, "Lost the coordinator before the end of the job\n");
+    return finished;
+}
+
+/**
+ * @brief Runs a worker of distributed estimations: connects to the
+ * coordinator, retrying every second until it answers, serves its job
+ * and, unless once is set, waits for the next coordinator.
+ * @param host Host of the coordinator.
+ * @param port TCP port of the coordinator.
+ * @param threads Sampling threads, 0 = one per core.
+ * @param once Return after the first job.
+ * @return false if the (only) job failed.
+ */
+bool runClusterWorker(const char *host, const char *port, int threads, bool once) {
+    bool waiting = false;
+    if (threads <= 0) threads = defaultWorkerCount();
+    signal(SIGPIPE, SIG_IGN);
+
+    for (;;) {
+        int fd = connectTo(host, port);
+        if (fd == -1) {
+            if (!waiting) fprintf(stderr, "Waiting for a coordinator at %s:%s\n", host, port);
+            waiting = true;
+            sleep(1);
+            continue;
+        }
+        waiting = false;
+        tuneConnection(fd, false);
+
+        bool ok = serveCoordinator(fd, threads);
+        close(fd);
+        if (once) return ok;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef MC_CLUSTER_H
+#define MC_CLUSTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mc_estimator.h"
+
+#define CLUSTER_MAGIC 0x4d434331u       // "MCC1"
+#define UNIT_CHUNKS_PER_THREAD 4        // chunks handed to a worker at a time, per thread
+#define DEFAULT_WORKER_TIMEOUT 30.0     // seconds of silence after which a busy worker is dead
+
+/*
+ * Distributed estimation over TCP: one coordinator, any number of workers.
+ *
+ * The coordinator owns the run. It loads the polygon, listens on a TCP
+ * port and hands out chunks (mc_estimator.h) to whatever workers connect,
+ * on any host. A worker registers with a HELLO carrying its thread count
+ * and receives a JOB: the run's parameters and the polygon's rings, from
+ * which it builds the same model as the coordinator. It then receives
+ * ASSIGN messages, each a unit of consecutive chunks, samples them with a
+ * local thread pool and answers one RESULT per finished chunk. A new unit
+ * is assigned once every chunk of the previous one was reported, so fast
+ * workers get more units. FINISH ends the job.
+ *
+ * Chunk c always draws from PRNG substream c, so the chunks are disjoint
+ * whoever samples them, and the estimate is the one of any local backend
+ * for the same seed. A worker is dead when its connection closes or when
+ * it holds a unit and stays silent longer than the worker timeout; the
+ * chunks of its unit not reported yet go back to the queue for the next
+ * free worker. A connection that sends no HELLO within a few seconds is
+ * closed; until then it waits in the poll set like any other worker. A chunk is counted once, on its first RESULT, so a late
+ * answer from a worker presumed dead changes nothing.
+ *
+ * Messages are fixed-size records in the byte order of the sender. A
+ * worker of the other byte order fails the magic check and is refused;
+ * nodes of one rack share it.
+ */
+typedef enum {
+    CLUSTER_HELLO,      // worker -> coordinator: count = threads
+    CLUSTER_JOB,        // coordinator -> worker: followed by ClusterJob and the rings
+    CLUSTER_ASSIGN,     // coordinator -> worker: chunks [chunk, chunk + count)
+    CLUSTER_RESULT,     // worker -> coordinator: samples and hits of chunk
+    CLUSTER_FINISH      // coordinator -> worker: the job is over
+} ClusterMessageType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t type;      // ClusterMessageType
+    int64_t chunk;
+    int64_t count;
+    int64_t samples;
+    int64_t hits;
+} ClusterMessage;
+
+/*
+ * Parameters of a job, followed on the wire by numPoints Points, the
+ * numRings + 1 ring offsets and the numRings ring regions (int32_t).
+ */
+typedef struct {
+    uint64_t seed;
+    int64_t totalPoints;
+    int64_t throttle;
+    uint32_t sampler;   // SamplerKind
+    uint32_t domain;    // DomainKind
+    int32_t numPoints;
+    int32_t numRings;
+    int32_t numRegions;
+    uint32_t reserved;
+} ClusterJob;
+
+bool runCoordinator(const char *port, const char *filename, const EstimatorConfig *config, double workerTimeout,
+                    Estimate *estimate, int *workers);
+bool runClusterWorker(const char *host, const char *port, int threads, bool once);
+
+#endif
@@ -0,0 +1,422 @@
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_daemon.h"
+#include "mc_pool.h"
+
+#define CLIENT_TIMEOUT_S 5
+
+/*
+ * The last polygon loaded by a worker, kept while the file on disk has the
+ * same device, inode, size and modification time.
+ */
+typedef struct {
+    bool loaded;
+    char path[PATH_MAX];
+    struct stat st;
+    PolygonModel model;
+} CachedPolygon;
+
+typedef struct {
+    int workers;
+    int listenfd;
+    int *fds;       // daemon end of each worker's socketpair
+    pid_t *pids;
+} WorkerPool;
+
+static volatile sig_atomic_t stopDaemon = 0;
+
+static void requestStop(int sig) {
+    (void)sig;
+    stopDaemon = 1;
+}
+
+static void stopSignals(sigset_t *set) {
+    sigemptyset(set);
+    sigaddset(set, SIGINT);
+    sigaddset(set, SIGTERM);
+}
+
+static bool sameFile(const struct stat *a, const struct stat *b) {
+    return a->st_dev == b->st_dev && a->st_ino == b->st_ino && a->st_size == b->st_size &&
+           a->st_mtim.tv_sec == b->st_mtim.tv_sec && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Makes the cache hold the polygon at path, reloading it only if
+ * another file is asked for or the file changed since it was loaded.
+ * @return false if the polygon could not be loaded.
+ */
+static bool cachePolygon(CachedPolygon *cache, const char *path) {
+    struct stat st;
+    if (stat(path, &st) == -1) {
+        perror(path);
+        return false;
+    }
+    if (cache->loaded && strcmp(cache->path, path) == 0 && sameFile(&cache->st, &st)) return true;
+
+    if (cache->loaded) freePolygonModel(&cache->model);
+    cache->loaded = loadPolygonModel(path, &cache->model);
+    if (cache->loaded) {
+        strcpy(cache->path, path);
+        cache->st = st;
+    }
+    return cache->loaded;
+}
+
+/**
+ * @brief Reads one job request and the path that follows it.
+ * @param fd Descriptor to read from.
+ * @param request Output: the request.
+ * @param path Output: the path, '\0'-terminated, of at most PATH_MAX bytes.
+ * @return false at end of file, on a read error or on a malformed request.
+ */
+static bool readRequest(int fd, JobRequest *request, char *path) {
+    if (readn(fd, request, sizeof(*request)) != (ssize_t)sizeof(*request)) return false;
+    if (request->magic != JOB_MAGIC || request->pathLength == 0 || request->pathLength >= PATH_MAX) return false;
+    if (readn(fd, path, request->pathLength) != (ssize_t)request->pathLength) return false;
+    path[request->pathLength] = '\0';
+    return true;
+}
+
+/**
+ * @brief Sends a job request and its path in a single write.
+ */
+static bool writeRequest(int fd, const JobRequest *request, const char *path) {
+    char buffer[sizeof(JobRequest) + PATH_MAX];
+    size_t size = sizeof(*request) + request->pathLength;
+
+    memcpy(buffer, request, sizeof(*request));
+    memcpy(buffer + sizeof(*request), path, request->pathLength);
+    return writen(fd, buffer, size) == (ssize_t)size;
+}
+
+/**
+ * @brief Body of a pooled worker: serves jobs until the daemon closes its end.
+ * @param fd The worker's end of its socketpair.
+ * @param worker Worker number, in [0, workers).
+ * @param workers Size of the pool.
+ */
+static void daemonWorker(int fd, int worker, int workers) {
+    CachedPolygon cache = {.loaded = false};
+    JobRequest request;
+    char path[PATH_MAX];
+
+    while (readRequest(fd, &request, path)) {
+        JobReply reply = {JOB_REPLY_MAGIC, JOB_OK, 0, 0, 0, 0, workers, 0};
+
+        if (!cachePolygon(&cache, path)) {
+            reply.status = JOB_LOAD_FAILED;
+        } else {
+            EstimatorConfig config;
+            initEstimatorConfig(&config, BACKEND_SOCKET);
+            config.workers = workers;
+            config.totalPoints = request.totalPoints;
+            config.seed = request.seed;
+            config.sampler = (SamplerKind)request.sampler;
+            config.domain = (DomainKind)request.domain;
+
+            Tally tally = sampleWorkerChunks(&cache.model, &config, worker, NULL, NULL);
+            reply.samples = tally.samples;
+            reply.hits = tally.hits;
+            samplingAreas(&cache.model, config.domain, &reply.domainArea, &reply.knownArea);
+        }
+
+        if (writen(fd, &reply, sizeof(reply)) != (ssize_t)sizeof(reply)) break;
+    }
+
+    if (cache.loaded) freePolygonModel(&cache.model);
+    close(fd);
+}
+
+/**
+ * @brief Forks worker number worker of the pool, connected by a new socketpair.
+ * @return false if the socketpair or the fork failed.
+ */
+static bool spawnWorker(WorkerPool *pool, int worker) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1) {
+        perror("socketpair failed");
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("Fork failed");
+        close(pair[0]);
+        close(pair[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // O filho só fica com a sua ponta: a morte de outro trabalhador tem de dar EOF ao daemon
+        sigset_t signals;
+        stopSignals(&signals);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        sigprocmask(SIG_UNBLOCK, &signals, NULL);
+        close(pair[0]);
+        close(pool->listenfd);
+        for (int k = 0; k < pool->workers; k++) {
+            if (pool->fds[k] != -1) close(pool->fds[k]);
+        }
+        daemonWorker(pair[1], worker, pool->workers);
+        _exit(0);
+    }
+
+    close(pair[1]);
+    pool->fds[worker] = pair[0];
+    pool->pids[worker] = pid;
+    return true;
+}
+
+/**
+ * @brief Kills a worker that stopped answering and forks a fresh one in its place.
+ */
+static void respawnWorker(WorkerPool *pool, int worker) {
+    fprintf(stderr, "Worker %d failed, restarting it\n", worker);
+    if (pool->fds[worker] != -1) {
+        close(pool->fds[worker]);
+        pool->fds[worker] = -1;
+        kill(pool->pids[worker], SIGKILL);
+        waitpid(pool->pids[worker], NULL, 0);
+    }
+    spawnWorker(pool, worker);
+}
+
+/**
+ * @brief Runs one job on every worker of the pool and sums their replies.
+ * @param pool The pool.
+ * @param request Validated request of the client.
+ * @param path Path of the polygon file.
+ * @param reply Output: the combined reply.
+ */
+static void runJob(WorkerPool *pool, const JobRequest *request, const char *path, JobReply *reply) {
+    bool *sent = calloc(pool->workers, sizeof(bool));
+    if (sent == NULL) {
+        reply->status = JOB_WORKER_FAILED;
+        return;
+    }
+
+    for (int i = 0; i < pool->workers; i++) {
+        sent[i] = pool->fds[i] != -1 && writeRequest(pool->fds[i], request, path);
+        if (!sent[i]) {
+            // Trabalhador morto entre trabalhos: substituí-lo ainda não perde nada
+            respawnWorker(pool, i);
+            sent[i] = pool->fds[i] != -1 && writeRequest(pool->fds[i], request, path);
+        }
+    }
+
+    for (int i = 0; i < pool->workers; i++) {
+        JobReply part;
+        if (!sent[i] || readn(pool->fds[i], &part, sizeof(part)) != (ssize_t)sizeof(part) ||
+            part.magic != JOB_REPLY_MAGIC) {
+            reply->status = JOB_WORKER_FAILED;
+            respawnWorker(pool, i);
+            continue;
+        }
+        if (part.status != JOB_OK) {
+            if (reply->status == JOB_OK) reply->status = part.status;
+            continue;
+        }
+        reply->samples += part.samples;
+        reply->hits += part.hits;
+        reply->domainArea = part.domainArea;
+        reply->knownArea = part.knownArea;
+    }
+    free(sent);
+}
+
+/**
+ * @brief Reads a client's job, runs it and sends back the reply.
+ */
+static void serveClient(WorkerPool *pool, int client) {
+    JobRequest request;
+    char path[PATH_MAX];
+    JobReply reply = {JOB_REPLY_MAGIC, JOB_OK, 0, 0, 0, 0, pool->workers, 0};
+
+    struct timeval timeout = {CLIENT_TIMEOUT_S, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (!readRequest(client, &request, path) || request.totalPoints <= 0 || request.sampler > SAMPLER_SOBOL ||
+        request.domain > DOMAIN_CELLS) {
+        reply.status = JOB_BAD_REQUEST;
+    } else {
+        runJob(pool, &request, path, &reply);
+    }
+    writen(client, &reply, sizeof(reply));
+}
+
+/**
+ * @brief Binds the daemon's listening socket, refusing to take over the
+ * socket of a daemon that is still running.
+ * @return The listening socket, or -1.
+ */
+static int listenOn(const char *socketPath) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socketPath);
+        return -1;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("Socket creation failed");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "A daemon is already listening on %s\n", socketPath);
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath);
+    if (fd == -1 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1) {
+        perror("Failed to bind or listen on socket");
+        if (fd != -1) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Runs the estimation daemon until SIGINT or SIGTERM.
+ * @param socketPath Path of the AF_UNIX socket clients connect to.
+ * @param workers Size of the worker pool, 0 = one per core.
+ * @return false if the daemon could not start.
+ */
+bool runDaemon(const char *socketPath, int workers) {
+    WorkerPool pool = {workers > 0 ? workers : defaultWorkerCount(), -1, NULL, NULL};
+
+    // Os sinais de paragem ficam bloqueados fora do pselect(): um trabalho nunca é interrompido a meio
+    sigset_t signals, waitMask;
+    struct sigaction action = {.sa_handler = requestStop};
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    stopSignals(&signals);
+    sigprocmask(SIG_BLOCK, &signals, &waitMask);
+
+    pool.listenfd = listenOn(socketPath);
+    if (pool.listenfd == -1) return false;
+
+    pool.fds = malloc(pool.workers * sizeof(int));
+    pool.pids = malloc(pool.workers * sizeof(pid_t));
+    bool ok = pool.fds != NULL && pool.pids != NULL;
+    for (int i = 0; ok && i < pool.workers; i++) pool.fds[i] = -1;
+    for (int i = 0; ok && i < pool.workers; i++) ok = spawnWorker(&pool, i);
+
+    if (ok) {
+        printf("Daemon listening on %s with %d workers\n", socketPath, pool.workers);
+        fflush(stdout);
+    }
+    while (ok && !stopDaemon) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(pool.listenfd, &readable);
+        if (pselect(pool.listenfd + 1, &readable, NULL, NULL, NULL, &waitMask) == -1) {
+            if (errno == EINTR) continue;
+            perror("pselect failed");
+            break;
+        }
+
+        int client = accept(pool.listenfd, NULL, NULL);
+        if (client == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("accept failed");
+            break;
+        }
+        serveClient(&pool, client);
+        close(client);
+    }
+
+    // Fechar a ponta do daemon dá EOF a cada trabalhador, que termina
+    for (int i = 0; pool.fds != NULL && i < pool.workers; i++) {
+        if (pool.fds[i] == -1) continue;
+        close(pool.fds[i]);
+        waitpid(pool.pids[i], NULL, 0);
+    }
+    close(pool.listenfd);
+    unlink(socketPath);
+    free(pool.fds);
+    free(pool.pids);
+    sigprocmask(SIG_SETMASK, &waitMask, NULL);
+    return ok;
+}
+
+/**
+ * @brief Sends one estimation to a running daemon and waits for the result.
+ * @param socketPath Path of the daemon's socket.
+ * @param filename Polygon file; it is sent as an absolute path.
+ * @param config Points, seed and sampler of the run; the daemon's pool
+ * replaces workers and the backend.
+ * @param estimate Output: the tally and the area estimate.
+ * @param workers Output: size of the daemon's pool.
+ * @return false if the daemon is unreachable or the job failed.
+ */
+bool submitJob(const char *socketPath, const char *filename, const EstimatorConfig *config,
+               Estimate *estimate, int *workers) {
+    static const char *FAILURES[] = {
+        [JOB_BAD_REQUEST] = "rejected the request",
+        [JOB_LOAD_FAILED] = "could not load the polygon",
+        [JOB_WORKER_FAILED] = "lost a worker during the job",
+    };
+    char path[PATH_MAX];
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if (realpath(filename, path) == NULL) {
+        perror(filename);
+        return false;
+    }
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socketPath);
+        return false;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("Failed to connect to the daemon");
+        if (fd != -1) close(fd);
+        return false;
+    }
+
+    JobRequest request = {JOB_MAGIC, config->sampler, config->seed, config->totalPoints, strlen(path), config->domain};
+    JobReply reply;
+    bool ok = writeRequest(fd, &request, path) &&
+              readn(fd, &reply, sizeof(reply)) == (ssize_t)sizeof(reply) && reply.magic == JOB_REPLY_MAGIC;
+    close(fd);
+
+    if (!ok) {
+        fprintf(stderr, "No valid reply from the daemon\n");
+        return false;
+    }
+    if (reply.status != JOB_OK) {
+        bool known = reply.status > JOB_OK && reply.status <= JOB_WORKER_FAILED;
+        fprintf(stderr, "The daemon %s\n", known ? FAILURES[reply.status] : "failed");
+        return false;
+    }
+
+    memset(estimate, 0, sizeof(*estimate));
+    estimate->tally.samples = reply.samples;
+    estimate->tally.hits = reply.hits;
+    estimate->domainArea = reply.domainArea;
+    estimate->knownArea = reply.knownArea;
+    estimate->area = reply.knownArea + (reply.samples > 0 ? reply.domainArea * reply.hits / reply.samples : 0);
+    *workers = reply.workers;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef MC_DAEMON_H
+#define MC_DAEMON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mc_estimator.h"
+
+#define JOB_MAGIC 0x4d434a32u       // "MCJ2"
+#define JOB_REPLY_MAGIC 0x4d434132u // "MCA2"
+
+/*
+ * Estimation daemon: a long-lived process with a pool of forked workers
+ * kept warm between jobs.
+ *
+ * A client connects to the daemon's AF_UNIX socket, sends one JobRequest
+ * followed by the absolute path of the polygon file, and reads one
+ * JobReply. The daemon forwards the same request to every worker over its
+ * socketpair; worker i samples the static share of chunks i of a run of
+ * pool-size workers, so the estimate matches the process backends for the
+ * same seed and worker count. Each worker keeps the last polygon it loaded
+ * and reuses it while the file is unchanged, so a job costs a few messages
+ * instead of forks and a reload. Jobs run one at a time, each on the whole
+ * pool; clients wait in the listen backlog.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t sampler;
+    uint64_t seed;
+    int64_t totalPoints;
+    uint32_t pathLength;    // bytes of the path that follows, without '\0'
+    uint32_t domain;        // DomainKind
+} JobRequest;
+
+typedef enum {
+    JOB_OK,
+    JOB_BAD_REQUEST,
+    JOB_LOAD_FAILED,
+    JOB_WORKER_FAILED
+} JobStatus;
+
+typedef struct {
+    uint32_t magic;
+    int32_t status;         // JobStatus
+    int64_t samples;
+    int64_t hits;
+    double domainArea;
+    double knownArea;
+    int32_t workers;
+    uint32_t reserved;
+} JobReply;
+
+bool runDaemon(const char *socketPath, int workers);
+bool submitJob(const char *socketPath, const char *filename, const EstimatorConfig *config,
+               Estimate *estimate, int *workers);
+
+#endif
@@ -0,0 +1,380 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "mc_backend.h"
+#include "mc_checkpoint.h"
+#include "mc_estimator.h"
+#include "mc_options.h"
+#include "mc_pool.h"
+#include "mc_rng.h"
+
+static const char *BACKEND_NAMES[] = {"file", "pipe", "socket", "threads", "ring"};
+static const char *DOMAIN_NAMES[] = {"box", "cells"};
+
+/**
+ * @brief Fills a configuration with the defaults of a backend.
+ * @param config Configuration to initialize.
+ * @param backend Backend to run.
+ */
+void initEstimatorConfig(EstimatorConfig *config, BackendKind backend) {
+    memset(config, 0, sizeof(*config));
+    config->backend = backend;
+    config->sampler = SAMPLER_UNIFORM;
+    config->rule.confidence = DEFAULT_CONFIDENCE;
+    config->rule.minSamples = MIN_ADAPTIVE_SAMPLES;
+    config->accuracy = DEFAULT_ACCURACY;
+    config->checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+}
+
+/**
+ * @brief Extracts the options shared by every driver from the command line:
+ * --seed, --sampler, --domain, --target-se, --target-rel, --confidence,
+ * --throttle, --checkpoint, --checkpoint-every, --resume, and the --exact,
+ * --validate and --accuracy of the reference modes.
+ * @param argc Argument count, updated when options are removed.
+ * @param argv Argument vector, updated when options are removed.
+ * @param config Configuration receiving the options.
+ * @return false if an option is malformed.
+ */
+bool takeEstimatorOptions(int *argc, char *argv[], EstimatorConfig *config) {
+    bool exact = takeFlag(argc, argv, "--exact");
+    bool validate = takeFlag(argc, argv, "--validate");
+    const char *domain;
+
+    if (exact && validate) return false;
+    config->mode = exact ? RUN_EXACT : validate ? RUN_VALIDATE : RUN_ESTIMATE;
+
+    if (takeOption(argc, argv, "--domain", &domain)) {
+        if (domain == NULL) return false;
+        if (strcmp(domain, DOMAIN_NAMES[DOMAIN_BOX]) == 0) config->domain = DOMAIN_BOX;
+        else if (strcmp(domain, DOMAIN_NAMES[DOMAIN_CELLS]) == 0) config->domain = DOMAIN_CELLS;
+        else return false;
+    }
+
+    config->resume = takeFlag(argc, argv, "--resume");
+    if (takeOption(argc, argv, "--checkpoint", &config->checkpointPath) && config->checkpointPath == NULL) return false;
+    if (config->resume && config->checkpointPath == NULL) return false;
+    if (config->checkpointPath != NULL && config->mode != RUN_ESTIMATE) return false;
+
+    return takeSeedOption(argc, argv, &config->seed) &&
+           takeSamplerOption(argc, argv, &config->sampler) &&
+           takeStopRule(argc, argv, &config->rule) &&
+           takeLongOption(argc, argv, "--throttle", &config->throttle) &&
+           config->throttle >= 0 &&
+           takeDoubleOption(argc, argv, "--checkpoint-every", &config->checkpointInterval) &&
+           config->checkpointInterval > 0 &&
+           takeDoubleOption(argc, argv, "--accuracy", &config->accuracy) &&
+           config->accuracy > 0;
+}
+
+/**
+ * @brief Extracts an optional "--backend <name>" from the command line.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param backend Output: the backend; left unchanged when absent.
+ * @return false if the name is missing or unknown.
+ */
+bool takeBackendOption(int *argc, char *argv[], BackendKind *backend) {
+    const char *name;
+
+    if (!takeOption(argc, argv, "--backend", &name)) return true;
+    if (name == NULL) return false;
+
+    for (int k = 0; k < (int)(sizeof(BACKEND_NAMES) / sizeof(BACKEND_NAMES[0])); k++) {
+        if (strcmp(name, BACKEND_NAMES[k]) == 0) {
+            *backend = (BackendKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the command-line name of a backend.
+ */
+const char *backendName(BackendKind backend) {
+    return BACKEND_NAMES[backend];
+}
+
+/**
+ * @brief Returns the command-line name of a sampling domain.
+ */
+const char *domainName(DomainKind domain) {
+    return DOMAIN_NAMES[domain];
+}
+
+/**
+ * @brief Splits the area of a polygon into the sampled and the exactly known parts.
+ * @param model Polygon to sample.
+ * @param domain Sampling domain of the run.
+ * @param domainArea Output: area of the domain the points are drawn from.
+ * @param knownArea Output: area inside the polygon outside that domain (inside cells).
+ */
+void samplingAreas(const PolygonModel *model, DomainKind domain, double *domainArea, double *knownArea) {
+    const CellGrid *grid = &model->grid;
+    double cellArea = model->domainArea / ((double)grid->cols * grid->rows);
+
+    *domainArea = domain == DOMAIN_CELLS ? grid->numBoundaryCells * cellArea : model->domainArea;
+    *knownArea = domain == DOMAIN_CELLS ? grid->numInsideCells * cellArea : 0;
+}
+
+/**
+ * @brief Number of chunks of a run.
+ */
+long chunkCount(const EstimatorConfig *config) {
+    return (config->totalPoints + CHUNK_POINTS - 1) / CHUNK_POINTS;
+}
+
+/**
+ * @brief Static share of a worker: the chunks [first, last).
+ * @param config Configuration of the run (workers already resolved).
+ * @param worker Worker number, in [0, config->workers).
+ * @param first Output: first chunk of the worker.
+ * @param last Output: one past the last chunk of the worker.
+ */
+void workerChunks(const EstimatorConfig *config, int worker, long *first, long *last) {
+    long chunks = chunkCount(config);
+    *first = chunks * worker / config->workers;
+    *last = chunks * (worker + 1) / config->workers;
+}
+
+/**
+ * @brief Samples one chunk of the run, batch by batch.
+ * @param model Polygon to sample.
+ * @param config Configuration of the run.
+ * @param chunk Chunk number; it selects both the points and the PRNG substream.
+ * @param sink Optional callback (may be NULL) receiving every batch.
+ * @param ctx Context passed to sink.
+ * @return Samples drawn and samples inside; fewer than CHUNK_POINTS if sink stopped the chunk.
+ */
+Tally sampleChunk(const PolygonModel *model, const EstimatorConfig *config, long chunk,
+                  BatchSink sink, void *ctx) {
+    return sampleChunkRegions(model, config, chunk, sink, ctx, NULL);
+}
+
+/**
+ * @brief sampleChunk() that also counts the samples inside each region.
+ * @param model Polygon to sample.
+ * @param config Configuration of the run.
+ * @param chunk Chunk number; it selects both the points and the PRNG substream.
+ * @param sink Optional callback (may be NULL) receiving every batch.
+ * @param ctx Context passed to sink.
+ * @param regionHits Optional (may be NULL) array of model->numRegions counters, incremented.
+ * @return Samples drawn and samples inside the union of the regions.
+ */
+Tally sampleChunkRegions(const PolygonModel *model, const EstimatorConfig *config, long chunk,
+                         BatchSink sink, void *ctx, long *regionHits) {
+    Tally tally = {0, 0};
+    double xs[BATCH_SIZE], ys[BATCH_SIZE];
+    unsigned char inside[BATCH_SIZE];
+    long first = chunk * CHUNK_POINTS;
+    long last = first + CHUNK_POINTS < config->totalPoints ? first + CHUNK_POINTS : config->totalPoints;
+    Rng rng;
+    Sampler sampler;
+    unsigned char *parity = NULL;
+    int *regions = NULL;
+
+    // Pedaço já acabado antes de retomar: os seus totais vêm do checkpoint
+    if (config->checkpoint && chunkDone(config->checkpoint, chunk)) return tally;
+
+    // Várias regiões: a paridade global não basta, cada região tem a sua
+    if (model->numRegions > 1) {
+        parity = calloc(model->numRegions, 1);
+        regions = malloc(model->numRegions * sizeof(int));
+        if (parity == NULL || regions == NULL) {
+            fprintf(stderr, "Failed to allocate the region buffers\n");
+            free(parity);
+            free(regions);
+            return tally;
+        }
+    }
+
+    // Domínio apertado: pontos do quadrado unitário levados para as células de fronteira
+    BoundingBox unit = {0, 1, 0, 1};
+    bool cells = config->domain == DOMAIN_CELLS;
+    rngSubstream(&rng, config->seed, chunk);
+    initSampler(&sampler, config->sampler, cells ? unit : model->grid.box, &rng, config->seed, first,
+                config->totalPoints);
+
+    for (long i = first; i < last; i += BATCH_SIZE) {
+        int count = last - i < BATCH_SIZE ? last - i : BATCH_SIZE;
+        samplerFill(&sampler, xs, ys, count);
+        if (cells) mapToBoundaryCells(&model->grid, xs, ys, count);
+        int hits = parity ? countRegionsBatch(&model->grid, xs, ys, count, inside, regionHits, parity, regions)
+                          : countInsideBatch(&model->grid, xs, ys, count, inside);
+        tally.samples += count;
+        tally.hits += hits;
+
+        // Abrandamento opcional (--throttle), por exemplo para ver o progresso
+        if (config->throttle > 0) usleep(config->throttle * count);
+        if (sink && !sink(ctx, xs, ys, inside, count, hits)) break;
+    }
+
+    // Só um pedaço completo conta como acabado; um interrompido recomeça do início
+    if (config->checkpoint && tally.samples == last - first) recordChunk(config->checkpoint, chunk, tally.hits);
+
+    free(parity);
+    free(regions);
+    return tally;
+}
+
+/**
+ * @brief Tells whether the run may stop early on its stop rule. Stratified
+ * points fill the strata row by row over the whole budget, so an early stop
+ * would only have sampled the bottom of the box; the combination is refused.
+ * @param config Configuration of the run.
+ * @return false (with a message) for a stop rule with the stratified sampler.
+ */
+bool stopRuleSupported(const EstimatorConfig *config) {
+    if (stopRuleActive(&config->rule) && config->sampler == SAMPLER_STRATIFIED) {
+        fprintf(stderr, "The stratified sampler needs the whole budget; it cannot be used with a stop rule\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the configured backend over an already built polygon model.
+ * @param model Polygon to sample.
+ * @param config Configuration of the run; workers <= 0 means one per core.
+ * @param tally Output: samples drawn and samples inside.
+ * @return false if the run failed or the configuration is not supported.
+ */
+bool runEstimator(const PolygonModel *model, const EstimatorConfig *config, Tally *tally) {
+    EstimatorConfig resolved = *config;
+    if (resolved.workers <= 0) resolved.workers = defaultWorkerCount();
+
+    if (resolved.totalPoints <= 0) {
+        fprintf(stderr, "The number of points must be positive\n");
+        return false;
+    }
+    if (!stopRuleSupported(&resolved)) return false;
+    if (stopRuleActive(&resolved.rule) && resolved.backend != BACKEND_THREADS) {
+        fprintf(stderr, "Adaptive stopping is only supported by the threads backend\n");
+        return false;
+    }
+
+    if (resolved.checkpointPath != NULL && stopRuleActive(&resolved.rule)) {
+        fprintf(stderr, "Checkpoints need a fixed number of points, not a stop rule\n");
+        return false;
+    }
+
+    Checkpoint checkpoint;
+    if (resolved.checkpointPath != NULL) {
+        if (!openCheckpoint(&checkpoint, model, &resolved)) return false;
+        if (checkpoint.restoredChunks > 0) {
+            fprintf(stderr, "Resuming from %s: %ld of %ld chunks already done\n", checkpoint.path,
+                    checkpoint.restoredChunks, checkpoint.chunks);
+        }
+        if (!startCheckpointSaver(&checkpoint)) fprintf(stderr, "Failed to start the checkpoint thread\n");
+        resolved.checkpoint = &checkpoint;
+    }
+
+    bool ok = false;
+    tally->samples = tally->hits = 0;
+    switch (resolved.backend) {
+        case BACKEND_FILE: ok = runFileBackend(model, &resolved, tally); break;
+        case BACKEND_PIPE: ok = runPipeBackend(model, &resolved, tally); break;
+        case BACKEND_SOCKET: ok = runSocketBackend(model, &resolved, tally); break;
+        case BACKEND_THREADS: ok = runThreadsBackend(model, &resolved, tally); break;
+        case BACKEND_RING: ok = runRingBackend(model, &resolved, tally); break;
+    }
+
+    if (resolved.checkpoint != NULL) {
+        tally->samples += checkpoint.restoredSamples;
+        tally->hits += checkpoint.restoredHits;
+        if (!closeCheckpoint(&checkpoint)) ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief Adds the area of each region's inside cells, counted without sampling.
+ * @param model Polygon with several regions.
+ * @param domain Sampling domain of the run; nothing is added for DOMAIN_BOX.
+ * @param regionKnownArea Array of model->numRegions areas, incremented.
+ */
+static void addInsideCells(const PolygonModel *model, DomainKind domain, double *regionKnownArea) {
+    const CellGrid *grid = &model->grid;
+    double cellArea = model->domainArea / ((double)grid->cols * grid->rows);
+
+    if (domain != DOMAIN_CELLS) return;
+    for (long cell = 0; cell < (long)grid->cols * grid->rows; cell++) {
+        if (grid->cells[cell] == CELL_INSIDE) regionKnownArea[grid->cellRegion[cell]] += cellArea;
+    }
+}
+
+/**
+ * @brief Loads a polygon file and runs the configured backend.
+ * @param filename Path of the text or binary polygon file.
+ * @param config Configuration of the run.
+ * @param estimate Output: the tally and the area estimate.
+ * @return false if the polygon could not be loaded or the run failed.
+ */
+bool estimateArea(const char *filename, const EstimatorConfig *config, Estimate *estimate) {
+    PolygonModel model;
+    memset(estimate, 0, sizeof(*estimate));
+    if (!stopRuleSupported(config) || !loadPolygonModel(filename, &model)) return false;
+
+    bool ok;
+    if (model.numRegions > 1 && config->backend == BACKEND_THREADS && config->checkpointPath == NULL) {
+        // Só o backend de threads conta as regiões; os outros (e os checkpoints) estimam a união
+        estimate->regionHits = calloc(model.numRegions, sizeof(long));
+        estimate->regionArea = malloc(model.numRegions * sizeof(double));
+        estimate->regionKnownArea = calloc(model.numRegions, sizeof(double));
+        ok = estimate->regionHits != NULL && estimate->regionArea != NULL && estimate->regionKnownArea != NULL;
+        if (ok) {
+            EstimatorConfig resolved = *config;
+            if (resolved.workers <= 0) resolved.workers = defaultWorkerCount();
+            estimate->numRegions = model.numRegions;
+            memcpy(estimate->regionArea, model.regionArea, model.numRegions * sizeof(double));
+            addInsideCells(&model, config->domain, estimate->regionKnownArea);
+            ok = resolved.totalPoints > 0 &&
+                 runThreadsRegions(&model, &resolved, &estimate->tally, estimate->regionHits);
+            if (resolved.totalPoints <= 0) fprintf(stderr, "The number of points must be positive\n");
+        } else {
+            fprintf(stderr, "Failed to allocate the region counters\n");
+        }
+    } else {
+        ok = runEstimator(&model, config, &estimate->tally);
+    }
+    samplingAreas(&model, config->domain, &estimate->domainArea, &estimate->knownArea);
+    estimate->area = estimate->knownArea + (estimate->tally.samples > 0
+                   ? estimate->domainArea * estimate->tally.hits / estimate->tally.samples : 0);
+    freePolygonModel(&model);
+    return ok;
+}
+
+/**
+ * @brief Frees the per-region arrays of an estimate.
+ */
+void freeEstimate(Estimate *estimate) {
+    free(estimate->regionHits);
+    free(estimate->regionArea);
+    free(estimate->regionKnownArea);
+    estimate->regionHits = NULL;
+    estimate->regionArea = NULL;
+    estimate->regionKnownArea = NULL;
+    estimate->numRegions = 0;
+}
+
+/**
+ * @brief Draws a progress bar on the current terminal line.
+ * @param current Samples done.
+ * @param total Samples of the run.
+ */
+void displayProgress(long current, long total) {
+    int barWidth = 70;
+    double progress = total > 0 ? (double)current / total : 1;
+    int pos = barWidth * progress;
+
+    printf("\r[");
+    for (int i = 0; i < barWidth; ++i) {
+        if (i < pos) printf("=");
+        else if (i == pos) printf(">");
+        else printf(" ");
+    }
+    printf("] %d%%", (int)(progress * 100.0));
+    fflush(stdout);
+}
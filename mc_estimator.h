@@ -0,0 +1,140 @@
+#ifndef MC_ESTIMATOR_H
+#define MC_ESTIMATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mc_batch.h"
+#include "mc_polygon.h"
+#include "mc_sampler.h"
+#include "mc_stats.h"
+
+#define CHUNK_POINTS (64 * BATCH_SIZE)
+#define DEFAULT_ACCURACY 1e-3   // relative error of --validate's time-to-accuracy
+
+/*
+ * Monte Carlo area estimator shared by every driver.
+ *
+ * A run of N points is cut into chunks of CHUNK_POINTS. Chunk c always
+ * draws the points [c * CHUNK_POINTS, ...) of the run's global sequence
+ * from PRNG substream c, whatever worker runs it. The backends only differ
+ * in how work reaches the workers and how results come back:
+ *  - file: forked children append "pid;samples;hits" under flock;
+ *  - pipe: forked children stream binary result records (mc_protocol.h),
+ *    with every point inside in verbose mode, through a shared pipe;
+ *  - socket: forked children publish progress in per-worker counters in
+ *    shared memory and send a partial result record per chunk over their
+ *    own AF_UNIX connection, read by an epoll loop while they run;
+ *  - threads: a work-stealing thread pool with per-worker counters;
+ *  - ring: forked children stream their points inside through per-worker
+ *    lock-free rings in POSIX shared memory (mc_ring.h).
+ * For a given seed every backend and worker count gives the same estimate,
+ * so backends can be benchmarked against each other on equal terms.
+ */
+typedef enum {
+    BACKEND_FILE,
+    BACKEND_PIPE,
+    BACKEND_SOCKET,
+    BACKEND_THREADS,
+    BACKEND_RING
+} BackendKind;
+
+/*
+ * What a driver does with the polygon: sample it, print its exact shoelace
+ * area without sampling, or compare sampling runs with the exact area
+ * (mc_validate.h).
+ */
+typedef enum {
+    RUN_ESTIMATE,
+    RUN_EXACT,
+    RUN_VALIDATE
+} RunMode;
+
+/*
+ * Where the points are drawn. DOMAIN_BOX samples the bounding box of the
+ * polygon. DOMAIN_CELLS samples only the boundary cells of its grid and
+ * adds the area of the inside cells exactly: this is the control variate
+ * "inside cells" (an inscribed shape of known area) with coefficient 1,
+ * sampled only where it can differ from the polygon, so the variance
+ * shrinks with the share of the box the boundary cells do not cover.
+ */
+typedef enum {
+    DOMAIN_BOX,
+    DOMAIN_CELLS
+} DomainKind;
+
+typedef struct Checkpoint Checkpoint;  // mc_checkpoint.h
+
+typedef struct {
+    RunMode mode;
+    BackendKind backend;
+    DomainKind domain;
+    int workers;        // processes or threads, 0 = one per core
+    long totalPoints;   // the budget, with an active stop rule
+    uint64_t seed;
+    SamplerKind sampler;
+    StopRule rule;
+    long throttle;      // microseconds of sleep per point, 0 = off
+    bool verbose;       // pipe and ring backends: stream every point inside
+    bool showProgress;
+    double accuracy;    // validation: relative error whose time-to-accuracy is reported
+    const char *checkpointPath;  // NULL = no checkpoint
+    double checkpointInterval;   // seconds between snapshots
+    bool resume;        // continue from the snapshot at checkpointPath
+    Checkpoint *checkpoint;      // set by runEstimator() during a checkpointed run
+} EstimatorConfig;
+
+typedef struct {
+    long samples;
+    long hits;
+} Tally;
+
+/*
+ * With several regions (mc_polygon.h), area is the area of their union and,
+ * on the threads backend, regionHits counts the samples inside each region,
+ * drawn from the same stream; regionArea holds their exact areas and
+ * regionKnownArea the part of each counted without sampling.
+ */
+typedef struct {
+    Tally tally;
+    double domainArea;  // area of the sampled domain
+    double knownArea;   // area counted exactly, outside the sampled domain
+    double area;        // knownArea + domainArea * hits / samples
+    int numRegions;     // 0 when regionHits is not filled
+    long *regionHits;
+    double *regionArea;
+    double *regionKnownArea;
+} Estimate;
+
+/**
+ * @brief Receives each batch sampled by sampleChunk().
+ * @param ctx Context given to sampleChunk().
+ * @param xs x coordinates of the batch.
+ * @param ys y coordinates of the batch.
+ * @param inside 1 for the points inside the polygon, 0 otherwise.
+ * @param count Number of points in the batch.
+ * @param hits Number of points inside.
+ * @return false to stop sampling the chunk.
+ */
+typedef bool (*BatchSink)(void *ctx, const double *xs, const double *ys,
+                          const unsigned char *inside, int count, int hits);
+
+void initEstimatorConfig(EstimatorConfig *config, BackendKind backend);
+bool takeEstimatorOptions(int *argc, char *argv[], EstimatorConfig *config);
+bool takeBackendOption(int *argc, char *argv[], BackendKind *backend);
+const char *backendName(BackendKind backend);
+const char *domainName(DomainKind domain);
+void samplingAreas(const PolygonModel *model, DomainKind domain, double *domainArea, double *knownArea);
+
+long chunkCount(const EstimatorConfig *config);
+void workerChunks(const EstimatorConfig *config, int worker, long *first, long *last);
+Tally sampleChunk(const PolygonModel *model, const EstimatorConfig *config, long chunk,
+                  BatchSink sink, void *ctx);
+Tally sampleChunkRegions(const PolygonModel *model, const EstimatorConfig *config, long chunk,
+                         BatchSink sink, void *ctx, long *regionHits);
+bool stopRuleSupported(const EstimatorConfig *config);
+bool runEstimator(const PolygonModel *model, const EstimatorConfig *config, Tally *tally);
+bool estimateArea(const char *filename, const EstimatorConfig *config, Estimate *estimate);
+void freeEstimate(Estimate *estimate);
+void displayProgress(long current, long total);
+
+#endif
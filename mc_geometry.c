@@ -0,0 +1,188 @@
+#include <math.h>
+#include "mc_geometry.h"
+
+/**
+ * @brief Determines the orientation of an ordered triplet (p, q, r).
+ * @param p First point of the triplet.
+ * @param q Second point of the triplet.
+ * @param r Third point of the triplet.
+ * @return 0 if p, q, and r are colinear, 1 if clockwise, 2 if counterclockwise.
+ */
+int orientation(Point p, Point q, Point r) {
+    double val = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+
+    if (val == 0) return 0;
+    return (val > 0)? 1: 2;
+}
+
+/**
+ * @brief Checks if point q lies on line segment pr.
+ * @param p First point of the line segment.
+ * @param q Point to check.
+ * @param r Second point of the line segment.
+ * @return true if point q lies on line segment pr, else false.
+ */
+bool onSegment(Point p, Point q, Point r) {
+    if (q.x <= fmax(p.x, r.x) && q.x >= fmin(p.x, r.x) &&
+        q.y <= fmax(p.y, r.y) && q.y >= fmin(p.y, r.y))
+       return true;
+
+    return false;
+}
+
+/**
+ * @brief Checks if line segments p1q1 and p2q2 intersect.
+ * @param p1 First point of the first line segment.
+ * @param q1 Second point of the first line segment.
+ * @param p2 First point of the second line segment.
+ * @param q2 Second point of the second line segment.
+ * @return true if line segments p1q1 and p2q2 intersect, else false.
+ */
+bool doIntersect(Point p1, Point q1, Point p2, Point q2) {
+
+    int o1 = orientation(p1, q1, p2);
+    int o2 = orientation(p1, q1, q2);
+    int o3 = orientation(p2, q2, p1);
+    int o4 = orientation(p2, q2, q1);
+
+    if (o1 != o2 && o3 != o4)
+        return true;
+
+    if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+    if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+    if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+    if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+
+    return false;
+}
+
+/**
+ * @brief Checks if a point p is inside a polygon of n points.
+ * @param polygon[] Array of points forming the polygon.
+ * @param n Number of points in the polygon.
+ * @param p Point to check.
+ * @return true if the point p is inside the polygon, else false.
+ */
+bool isInsidePolygon(Point polygon[], int n, Point p) {
+
+    if (n < 3) return false;
+
+    Point extreme = {2.5, p.y};
+
+    int count = 0, i = 0;
+    do {
+        int next = (i+1)%n;
+
+        if (doIntersect(polygon[i], polygon[next], p, extreme)) {
+            if (orientation(polygon[i], p, polygon[next]) == 0)
+               return onSegment(polygon[i], p, polygon[next]);
+            count++;
+        }
+        i = next;
+    } while (i != 0);
+
+    return count&1;
+}
+
+/**
+ * @brief Computes the axis-aligned bounding box of a polygon.
+ * @param polygon[] Array of points forming the polygon.
+ * @param n Number of points in the polygon (must be at least 1).
+ * @return The smallest box holding every vertex.
+ */
+BoundingBox computeBoundingBox(const Point polygon[], int n) {
+    BoundingBox box = {polygon[0].x, polygon[0].x, polygon[0].y, polygon[0].y};
+
+    for (int i = 1; i < n; i++) {
+        if (polygon[i].x < box.minX) box.minX = polygon[i].x;
+        if (polygon[i].x > box.maxX) box.maxX = polygon[i].x;
+        if (polygon[i].y < box.minY) box.minY = polygon[i].y;
+        if (polygon[i].y > box.maxY) box.maxY = polygon[i].y;
+    }
+
+    return box;
+}
+
+/**
+ * @brief Computes the area of a simple polygon with the shoelace formula.
+ * @param polygon[] Array of points forming the polygon.
+ * @param n Number of points in the polygon.
+ * @return The area, whatever the orientation of the vertices.
+ */
+double shoelaceArea(const Point polygon[], int n) {
+    double twice = 0;
+
+    // Coordenadas relativas ao primeiro vértice: menos cancelamento longe da origem
+    for (int i = 1; i + 1 < n; i++) {
+        twice += (polygon[i].x - polygon[0].x) * (polygon[i + 1].y - polygon[0].y) -
+                 (polygon[i + 1].x - polygon[0].x) * (polygon[i].y - polygon[0].y);
+    }
+
+    return (twice < 0 ? -twice : twice) / 2;
+}
+
+/**
+ * @brief Twice the signed area of the triangle pqr: positive when it turns counterclockwise.
+ */
+static inline double turn(Point p, Point q, Point r) {
+    return (q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x);
+}
+
+/**
+ * @brief Detects a convex polygon in one pass.
+ *
+ * The polygon is convex when every corner turns the same way (collinear
+ * corners are ignored) and the boundary winds around once, i.e. the x
+ * direction of its edges changes sign exactly twice.
+ * @param polygon[] Array of points forming the polygon.
+ * @param n Number of points in the polygon.
+ * @return 1 if convex and counterclockwise, -1 if convex and clockwise, 0 otherwise.
+ */
+int convexOrientation(const Point polygon[], int n) {
+    int sign = 0, flips = 0, firstDx = 0, lastDx = 0;
+
+    if (n < 3) return 0;
+    for (int i = 0; i < n; i++) {
+        Point a = polygon[i], b = polygon[(i + 1) % n], c = polygon[(i + 2) % n];
+        double t = turn(a, b, c);
+        if (t != 0) {
+            int s = t > 0 ? 1 : -1;
+            if (sign != 0 && s != sign) return 0;
+            sign = s;
+        }
+
+        int dx = (b.x > a.x) - (b.x < a.x);
+        if (dx == 0) continue;
+        if (firstDx == 0) firstDx = dx;
+        if (lastDx != 0 && dx != lastDx) flips++;
+        lastDx = dx;
+    }
+    if (lastDx != firstDx) flips++;
+
+    return flips == 2 ? sign : 0;
+}
+
+/**
+ * @brief Checks if a point is inside a convex polygon in O(log n).
+ *
+ * The point must lie in the wedge of the first vertex; a branch-free
+ * binary search then finds the triangle (v0, vi, vi+1) of the fan whose
+ * sector holds it, and the edge vi vi+1 decides.
+ * @param convex Convex polygon (orientation must not be 0).
+ * @param p Point to check.
+ * @return true if the point p is inside the polygon, else false.
+ */
+bool isInsideConvexPolygon(const ConvexPolygon *convex, Point p) {
+    const Point *v = convex->points;
+    Point o = v[0];
+    double s = convex->orientation;
+
+    // Um polígono no sentido horário é o espelho de um anti-horário: basta trocar os sinais
+    if (s * turn(o, v[1], p) < 0 || s * turn(o, v[convex->n - 1], p) > 0) return false;
+
+    const Point *base = v + 1;
+    for (int len = convex->n - 2; len > 1; len -= len / 2) {
+        base = s * turn(o, base[len / 2], p) >= 0 ? base + len / 2 : base;
+    }
+    return s * turn(base[0], base[1], p) >= 0;
+}
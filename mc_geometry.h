@@ -0,0 +1,37 @@
+#ifndef MC_GEOMETRY_H
+#define MC_GEOMETRY_H
+
+#include <stdbool.h>
+
+typedef struct {
+    double x;
+    double y;
+} Point;
+
+typedef struct {
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+} BoundingBox;
+
+/*
+ * A convex polygon tested by isInsideConvexPolygon(): a binary search over
+ * the fan of triangles from its first vertex, O(log n) per point.
+ */
+typedef struct {
+    const Point *points;
+    int n;
+    int orientation;    // 1 counterclockwise, -1 clockwise, 0 when the polygon is not convex
+} ConvexPolygon;
+
+int orientation(Point p, Point q, Point r);
+bool onSegment(Point p, Point q, Point r);
+bool doIntersect(Point p1, Point q1, Point p2, Point q2);
+bool isInsidePolygon(Point polygon[], int n, Point p);
+BoundingBox computeBoundingBox(const Point polygon[], int n);
+double shoelaceArea(const Point polygon[], int n);
+int convexOrientation(const Point polygon[], int n);
+bool isInsideConvexPolygon(const ConvexPolygon *convex, Point p);
+
+#endif
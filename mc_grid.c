@@ -0,0 +1,205 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mc_grid.h"
+
+// Margem, em unidades de célula, para que erros de arredondamento
+// nunca deixem uma célula atravessada por uma aresta por marcar
+#define GRID_EPSILON 1e-6
+
+static int clampCell(double c, int limit) {
+    if (c < 0) return 0;
+    if (c >= limit) return limit - 1;
+    return (int)c;
+}
+
+/**
+ * @brief Marks every cell touched by the segment ab as a boundary cell.
+ * @param grid Grid being built.
+ * @param a First point of the segment.
+ * @param b Second point of the segment.
+ */
+static void markEdge(CellGrid *grid, Point a, Point b) {
+    Point lo = a.y < b.y ? a : b;
+    Point hi = a.y < b.y ? b : a;
+    double rowLo = (lo.y - grid->box.minY) * grid->cellsPerUnitY;
+    double rowHi = (hi.y - grid->box.minY) * grid->cellsPerUnitY;
+    int firstRow = clampCell(floor(rowLo - GRID_EPSILON), grid->rows);
+    int lastRow = clampCell(floor(rowHi + GRID_EPSILON), grid->rows);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        // Troço da aresta contido na faixa horizontal desta linha
+        double bandLo = grid->box.minY + row / grid->cellsPerUnitY;
+        double bandHi = grid->box.minY + (row + 1) / grid->cellsPerUnitY;
+        double xa = lo.x, xb = hi.x;
+        if (hi.y > lo.y) {
+            double slope = (hi.x - lo.x) / (hi.y - lo.y);
+            if (bandLo > lo.y) xa = lo.x + (bandLo - lo.y) * slope;
+            if (bandHi < hi.y) xb = lo.x + (bandHi - lo.y) * slope;
+        }
+
+        double colLo = (fmin(xa, xb) - grid->box.minX) * grid->cellsPerUnitX;
+        double colHi = (fmax(xa, xb) - grid->box.minX) * grid->cellsPerUnitX;
+        int firstCol = clampCell(floor(colLo - GRID_EPSILON), grid->cols);
+        int lastCol = clampCell(floor(colHi + GRID_EPSILON), grid->cols);
+        memset(&grid->cells[row * grid->cols + firstCol], CELL_BOUNDARY, lastCol - firstCol + 1);
+    }
+}
+
+/**
+ * @brief Classifies a cell without edges by the regions holding its center.
+ */
+static void classifyCell(CellGrid *grid, int cell, Point center, unsigned char *parity, int *regions) {
+    if (grid->cellRegion == NULL) {
+        bool inside = grid->convex ? isInsideConvexPolygon(grid->convex, center) : isInsideSlabIndex(grid->index, center);
+        grid->cells[cell] = inside ? CELL_INSIDE : CELL_OUTSIDE;
+        return;
+    }
+
+    int count = regionsAtPoint(grid->index, center, parity, regions);
+    grid->cells[cell] = count == 0 ? CELL_OUTSIDE : count == 1 ? CELL_INSIDE : CELL_BOUNDARY;
+    grid->cellRegion[cell] = count == 1 ? regions[0] : 0;
+}
+
+/**
+ * @brief Builds the cell grid of a set of rings. Done once, before sampling.
+ *
+ * The resolution grows with the square root of the vertex count, between
+ * GRID_MIN_CELLS and GRID_MAX_CELLS cells per axis.
+ * @param points[] Vertices of all rings, ring after ring.
+ * @param ringStart[] Ring r is points[ringStart[r] .. ringStart[r + 1]).
+ * @param numRings Number of rings.
+ * @param numRegions Number of regions; with more than one, index must carry edgeRegion.
+ * @param index Slab index of the same rings, used for the exact test.
+ * @param convex Optional (may be NULL) single convex ring, tested instead of index.
+ * @param grid Grid to fill; release it with freeCellGrid().
+ * @return true on success, false for degenerate polygons or out of memory.
+ */
+bool buildCellGrid(const Point points[], const int ringStart[], int numRings, int numRegions,
+                   const SlabIndex *index, const ConvexPolygon *convex, CellGrid *grid) {
+    memset(grid, 0, sizeof(*grid));
+    int n = ringStart[numRings];
+    if (n < 3) return false;
+
+    grid->box = computeBoundingBox(points, n);
+    double width = grid->box.maxX - grid->box.minX;
+    double height = grid->box.maxY - grid->box.minY;
+    if (width <= 0 || height <= 0) return false;
+
+    int side = 4 * (int)ceil(sqrt(n));
+    if (side < GRID_MIN_CELLS) side = GRID_MIN_CELLS;
+    if (side > GRID_MAX_CELLS) side = GRID_MAX_CELLS;
+    grid->cols = grid->rows = side;
+    grid->cellsPerUnitX = grid->cols / width;
+    grid->cellsPerUnitY = grid->rows / height;
+    grid->index = index;
+    grid->convex = convex;
+
+    grid->numRegions = numRegions;
+
+    size_t cells = (size_t)grid->rows * grid->cols;
+    unsigned char *parity = NULL;
+    int *regions = NULL;
+    grid->cells = calloc(cells, 1);
+    if (numRegions > 1) {
+        grid->cellRegion = calloc(cells, sizeof(int));
+        parity = calloc(numRegions, 1);
+        regions = malloc(numRegions * sizeof(int));
+    }
+    if (grid->cells == NULL || (numRegions > 1 && (!grid->cellRegion || !parity || !regions))) {
+        free(parity);
+        free(regions);
+        freeCellGrid(grid);
+        return false;
+    }
+
+    for (int r = 0; r < numRings; r++) {
+        for (int i = ringStart[r]; i < ringStart[r + 1]; i++) {
+            int next = i + 1 < ringStart[r + 1] ? i + 1 : ringStart[r];
+            markEdge(grid, points[i], points[next]);
+        }
+    }
+
+    // Células sem arestas: o centro decide a célula inteira. Duas vizinhas sem
+    // arestas têm a mesma classe, por isso só a primeira de cada sequência é testada
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
+            int cell = row * grid->cols + col;
+            if (grid->cells[cell] == CELL_BOUNDARY) continue;
+            if (col > 0 && grid->cells[cell - 1] != CELL_BOUNDARY) {
+                grid->cells[cell] = grid->cells[cell - 1];
+                if (grid->cellRegion) grid->cellRegion[cell] = grid->cellRegion[cell - 1];
+                continue;
+            }
+            Point center = {grid->box.minX + (col + 0.5) / grid->cellsPerUnitX,
+                            grid->box.minY + (row + 0.5) / grid->cellsPerUnitY};
+            classifyCell(grid, cell, center, parity, regions);
+        }
+    }
+
+    free(parity);
+    free(regions);
+
+    // Células de fronteira por ordem: o domínio apertado de amostragem
+    for (size_t cell = 0; cell < cells; cell++) {
+        grid->numBoundaryCells += grid->cells[cell] == CELL_BOUNDARY;
+        grid->numInsideCells += grid->cells[cell] == CELL_INSIDE;
+    }
+    grid->boundaryCells = malloc(grid->numBoundaryCells * sizeof(int));
+    if (grid->boundaryCells == NULL) {
+        freeCellGrid(grid);
+        return false;
+    }
+    for (size_t cell = 0, k = 0; cell < cells; cell++) {
+        if (grid->cells[cell] == CELL_BOUNDARY) grid->boundaryCells[k++] = cell;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if a point is inside the polygon, using the grid when the
+ * cell is known to be fully inside or outside and the slab index otherwise.
+ * @param grid Grid built by buildCellGrid().
+ * @param p Point to check.
+ * @return true if the point p is inside the polygon, else false.
+ */
+bool isInsideGrid(const CellGrid *grid, Point p) {
+    switch (classifyPoint(grid, p)) {
+        case CELL_INSIDE: return true;
+        case CELL_OUTSIDE: return false;
+        default: return grid->convex ? isInsideConvexPolygon(grid->convex, p) : isInsideSlabIndex(grid->index, p);
+    }
+}
+
+/**
+ * @brief Maps points of the unit square onto the union of the boundary cells.
+ *
+ * x selects the boundary cell (all cells have the same area) and its
+ * fractional part the position in the cell, so uniform or low-discrepancy
+ * points of the unit square stay uniform or low-discrepancy over the cells.
+ * @param grid Grid built by buildCellGrid().
+ * @param xs x coordinates in [0, 1), replaced by the mapped ones.
+ * @param ys y coordinates in [0, 1), replaced by the mapped ones.
+ * @param count Number of points.
+ */
+void mapToBoundaryCells(const CellGrid *grid, double *xs, double *ys, int count) {
+    for (int i = 0; i < count; i++) {
+        double u = xs[i] * grid->numBoundaryCells;
+        int k = (int)u;
+        if (k >= grid->numBoundaryCells) k = grid->numBoundaryCells - 1;
+        int cell = grid->boundaryCells[k];
+        xs[i] = grid->box.minX + (cell % grid->cols + (u - k)) / grid->cellsPerUnitX;
+        ys[i] = grid->box.minY + (cell / grid->cols + ys[i]) / grid->cellsPerUnitY;
+    }
+}
+
+/**
+ * @brief Releases the memory held by a cell grid.
+ * @param grid Grid to release.
+ */
+void freeCellGrid(CellGrid *grid) {
+    free(grid->cells);
+    free(grid->cellRegion);
+    free(grid->boundaryCells);
+    memset(grid, 0, sizeof(*grid));
+}
@@ -0,0 +1,81 @@
+#ifndef MC_GRID_H
+#define MC_GRID_H
+
+#include <stdbool.h>
+#include "mc_geometry.h"
+#include "mc_slab.h"
+
+#define GRID_MIN_CELLS 16
+#define GRID_MAX_CELLS 1024
+
+typedef enum {
+    CELL_OUTSIDE = 0,
+    CELL_INSIDE = 1,
+    CELL_BOUNDARY = 2
+} CellClass;
+
+/*
+ * Uniform grid over the bounding box of a polygon. Every cell crossed by an
+ * edge is a boundary cell; every other cell lies entirely inside or entirely
+ * outside the polygon and answers a query without touching any edge. Only
+ * samples in boundary cells fall back to the slab index.
+ *
+ * With several regions, an inside cell lies inside exactly one region,
+ * recorded in cellRegion; a cell inside two overlapping regions is marked
+ * as a boundary cell so the exact test decides.
+ *
+ * A convex polygon may be built without slab index: its boundary cells
+ * then use the O(log n) fan test of isInsideConvexPolygon().
+ *
+ * boundaryCells lists the boundary cells, so a run can sample only them
+ * (mapToBoundaryCells) and add the area of the inside cells exactly.
+ */
+typedef struct {
+    BoundingBox box;
+    int cols;
+    int rows;
+    double cellsPerUnitX;
+    double cellsPerUnitY;
+    unsigned char *cells;   // rows * cols CellClass values, row-major
+    const SlabIndex *index; // exact test for boundary cells
+    const ConvexPolygon *convex; // exact test instead of index, or NULL
+    int numRegions;
+    int *cellRegion;        // region of each inside cell, NULL when there is a single region
+    int numBoundaryCells;
+    int *boundaryCells;     // row-major numbers of the boundary cells, in order
+    int numInsideCells;
+} CellGrid;
+
+bool buildCellGrid(const Point points[], const int ringStart[], int numRings, int numRegions,
+                   const SlabIndex *index, const ConvexPolygon *convex, CellGrid *grid);
+bool isInsideGrid(const CellGrid *grid, Point p);
+void mapToBoundaryCells(const CellGrid *grid, double *xs, double *ys, int count);
+void freeCellGrid(CellGrid *grid);
+
+/**
+ * @brief Returns the row-major number of the cell holding p, which must lie in the box.
+ */
+static inline int cellIndex(const CellGrid *grid, Point p) {
+    int col = (int)((p.x - grid->box.minX) * grid->cellsPerUnitX);
+    int row = (int)((p.y - grid->box.minY) * grid->cellsPerUnitY);
+    if (col < 0) col = 0;
+    if (col >= grid->cols) col = grid->cols - 1;
+    if (row < 0) row = 0;
+    if (row >= grid->rows) row = grid->rows - 1;
+    return row * grid->cols + col;
+}
+
+/**
+ * @brief Returns the class of the cell holding p (CELL_OUTSIDE off the grid).
+ * @param grid Grid built by buildCellGrid().
+ * @param p Point to classify.
+ * @return CELL_INSIDE, CELL_OUTSIDE or CELL_BOUNDARY.
+ */
+static inline CellClass classifyPoint(const CellGrid *grid, Point p) {
+    if (p.x < grid->box.minX || p.x > grid->box.maxX ||
+        p.y < grid->box.minY || p.y > grid->box.maxY) return CELL_OUTSIDE;
+
+    return (CellClass)grid->cells[cellIndex(grid, p)];
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mc_options.h"
+
+/**
+ * @brief Extracts "--name <value>" from the command line.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param name Option name, including the leading dashes.
+ * @param value Output: the option's value, or NULL if it has none.
+ * @return true if the option was present.
+ */
+bool takeOption(int *argc, char *argv[], const char *name, const char **value) {
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], name) != 0) continue;
+
+        int taken = i + 1 < *argc ? 2 : 1;
+        *value = taken == 2 ? argv[i + 1] : NULL;
+        for (int k = i; k + taken <= *argc; k++) argv[k] = argv[k + taken];
+        *argc -= taken;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Extracts "--name <integer>" from the command line.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param name Option name, including the leading dashes.
+ * @param value Output: the parsed value; left unchanged when absent.
+ * @return false if the option is present without a valid integer.
+ */
+bool takeLongOption(int *argc, char *argv[], const char *name, long *value) {
+    const char *text;
+    char *end;
+
+    if (!takeOption(argc, argv, name, &text)) return true;
+    if (text == NULL || *text == '\0') return false;
+
+    long parsed = strtol(text, &end, 10);
+    if (*end != '\0') return false;
+    *value = parsed;
+    return true;
+}
+
+/**
+ * @brief Extracts "--name <number>" from the command line.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param name Option name, including the leading dashes.
+ * @param value Output: the parsed value; left unchanged when absent.
+ * @return false if the option is present without a valid number.
+ */
+bool takeDoubleOption(int *argc, char *argv[], const char *name, double *value) {
+    const char *text;
+    char *end;
+
+    if (!takeOption(argc, argv, name, &text)) return true;
+    if (text == NULL || *text == '\0') return false;
+
+    double parsed = strtod(text, &end);
+    if (*end != '\0') return false;
+    *value = parsed;
+    return true;
+}
+
+/**
+ * @brief Extracts a "--name" flag, which takes no value, from the command line.
+ * @param argc Argument count, updated when the flag is removed.
+ * @param argv Argument vector, updated when the flag is removed.
+ * @param name Flag name, including the leading dashes.
+ * @return true if the flag was present.
+ */
+bool takeFlag(int *argc, char *argv[], const char *name) {
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], name) != 0) continue;
+
+        for (int k = i; k < *argc; k++) argv[k] = argv[k + 1];
+        (*argc)--;
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,17 @@
+#ifndef MC_OPTIONS_H
+#define MC_OPTIONS_H
+
+#include <stdbool.h>
+
+/*
+ * Optional "--name <value>" pairs and "--name" flags accepted anywhere on
+ * the command line. Each helper removes what it takes from argv, so the
+ * positional arguments keep their usual positions and the existing argc
+ * checks still apply.
+ */
+bool takeOption(int *argc, char *argv[], const char *name, const char **value);
+bool takeLongOption(int *argc, char *argv[], const char *name, long *value);
+bool takeDoubleOption(int *argc, char *argv[], const char *name, double *value);
+bool takeFlag(int *argc, char *argv[], const char *name);
+
+#endif
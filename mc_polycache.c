@@ -0,0 +1,179 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mc_polycache.h"
+#include "mc_polyfile.h"
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    return rotl64(acc + input * PRIME64_2, 31) * PRIME64_1;
+}
+
+static inline uint64_t xxhMerge(uint64_t acc, uint64_t value) {
+    return (acc ^ xxhRound(0, value)) * PRIME64_1 + PRIME64_4;
+}
+
+/**
+ * @brief XXH64 of a buffer with seed 0: four independent lanes over 32-byte
+ * stripes, so hashing runs at memory speed rather than a byte at a time.
+ */
+static uint64_t hashBytes(const void *data, size_t size) {
+    const unsigned char *p = data, *end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = PRIME64_1 + PRIME64_2, v2 = PRIME64_2, v3 = 0, v4 = -PRIME64_1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxhMerge(xxhMerge(xxhMerge(xxhMerge(h, v1), v2), v3), v4);
+    } else {
+        h = PRIME64_5;
+    }
+
+    h += size;
+    for (; p + 8 <= end; p += 8) h = rotl64(h ^ xxhRound(0, read64(p)), 27) * PRIME64_1 + PRIME64_4;
+    if (p + 4 <= end) {
+        uint32_t k;
+        memcpy(&k, p, sizeof(k));
+        h = rotl64(h ^ (uint64_t)k * PRIME64_1, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) h = rotl64(h ^ *p * PRIME64_5, 11) * PRIME64_1;
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    return h ^ (h >> 32);
+}
+
+/**
+ * @brief Resolves the cache directory from the environment.
+ * @return false if the cache is disabled or no directory can be found.
+ */
+static bool cacheDirectory(char *dir, size_t length) {
+    const char *env = getenv("MC_POLYGON_CACHE");
+    int n;
+
+    if (env != NULL) {
+        if (*env == '\0') return false;
+        n = snprintf(dir, length, "%s", env);
+    } else if ((env = getenv("XDG_CACHE_HOME")) != NULL && *env != '\0') {
+        n = snprintf(dir, length, "%s/monte_carlo", env);
+    } else if ((env = getenv("HOME")) != NULL && *env != '\0') {
+        n = snprintf(dir, length, "%s/.cache/monte_carlo", env);
+    } else {
+        return false;
+    }
+    return n > 0 && (size_t)n < length;
+}
+
+/**
+ * @brief Creates a directory and its missing parents, like "mkdir -p".
+ */
+static bool makeDirectories(char *path) {
+    for (char *p = path + 1; *p != '\0'; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        bool ok = mkdir(path, 0755) == 0 || errno == EEXIST;
+        *p = '/';
+        if (!ok) return false;
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+/**
+ * @brief Names the cache entry of a polygon text.
+ * @param text Bytes of the text file.
+ * @param size Number of bytes.
+ * @param entry Output: path of the entry.
+ * @param length Size of entry, at least POLYGON_CACHE_ENTRY_MAX.
+ * @return false if the cache is disabled.
+ */
+bool polygonCacheEntry(const void *text, size_t size, char *entry, size_t length) {
+    char dir[POLYGON_CACHE_ENTRY_MAX];
+    if (!cacheDirectory(dir, sizeof(dir))) return false;
+
+    int n = snprintf(entry, length, "%s/%016llx-%llx.mcpoly", dir,
+                     (unsigned long long)hashBytes(text, size), (unsigned long long)size);
+    return n > 0 && (size_t)n < length;
+}
+
+/**
+ * @brief Maps a cache entry as a model.
+ * @param entry Path given by polygonCacheEntry().
+ * @param model Output model; release it with freePolygonModel().
+ * @return false on a miss, or if the entry is unusable.
+ */
+bool attachCachedPolygon(const char *entry, PolygonModel *model) {
+    int fd = open(entry, O_RDONLY);
+    if (fd == -1) return false;
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    // Entradas de outra versão do formato são falhas silenciosas: serão reescritas
+    if (!isPolygonFile(data, st.st_size) || (size_t)st.st_size < sizeof(PolygonFileHeader) ||
+        ((const PolygonFileHeader *)data)->version != POLYGON_FILE_VERSION) {
+        munmap(data, st.st_size);
+        return false;
+    }
+    return attachPolygonFile(data, st.st_size, entry, model);
+}
+
+/**
+ * @brief Saves a freshly built model as the cache entry of its text.
+ *
+ * Failures are not reported: the cache is only an optimization.
+ * @param entry Path given by polygonCacheEntry().
+ * @param model Model built from the text.
+ */
+void storeCachedPolygon(const char *entry, const PolygonModel *model) {
+    char dir[POLYGON_CACHE_ENTRY_MAX], temporary[POLYGON_CACHE_ENTRY_MAX + 32];
+
+    snprintf(dir, sizeof(dir), "%s", entry);
+    char *slash = strrchr(dir, '/');
+    if (slash != NULL && slash != dir) {
+        *slash = '\0';
+        if (!makeDirectories(dir)) return;
+    }
+
+    // Nome único por chamada: vários threads do mesmo processo podem guardar a mesma entrada
+    snprintf(temporary, sizeof(temporary), "%s.XXXXXX", entry);
+    int fd = mkstemp(temporary);
+    if (fd == -1) return;
+    fchmod(fd, 0644);
+    close(fd);
+    if (!savePolygonFile(temporary, model) || rename(temporary, entry) == -1) unlink(temporary);
+}
@@ -0,0 +1,27 @@
+#ifndef MC_POLYCACHE_H
+#define MC_POLYCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mc_polygon.h"
+
+#define POLYGON_CACHE_ENTRY_MAX 4096
+
+/*
+ * On-disk cache of preprocessed polygons, keyed by the content of the text
+ * file: the entry of a file is named after a 64-bit hash (XXH64) and the
+ * size of its bytes, so renaming or copying a polygon still hits and any
+ * edit misses. An entry is a binary polygon file (mc_polyfile.h) holding
+ * the vertices, bounding box, shoelace area, slab index and cell grid, so
+ * a hit is one mmap and no parsing.
+ *
+ * The directory is $MC_POLYGON_CACHE, else $XDG_CACHE_HOME/monte_carlo,
+ * else $HOME/.cache/monte_carlo; an empty MC_POLYGON_CACHE disables the
+ * cache. Entries are written to a temporary file and renamed into place,
+ * so concurrent runs never see a partial entry.
+ */
+bool polygonCacheEntry(const void *text, size_t size, char *entry, size_t length);
+bool attachCachedPolygon(const char *entry, PolygonModel *model);
+void storeCachedPolygon(const char *entry, const PolygonModel *model);
+
+#endif
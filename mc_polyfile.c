@@ -0,0 +1,272 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "mc_polyfile.h"
+
+#define BYTE_ORDER_MARK 0x01020304u
+
+/**
+ * @brief Rounds an offset up to the next section boundary.
+ */
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + POLYGON_FILE_ALIGN - 1) / POLYGON_FILE_ALIGN * POLYGON_FILE_ALIGN;
+}
+
+/**
+ * @brief Tells whether a mapped file starts with the binary polygon magic.
+ */
+bool isPolygonFile(const void *data, size_t size) {
+    return size >= sizeof(PolygonFileHeader) && memcmp(data, POLYGON_FILE_MAGIC, 8) == 0;
+}
+
+/**
+ * @brief Checks that a section lies inside the file and is aligned.
+ */
+static bool sectionFits(uint64_t offset, uint64_t length, size_t size) {
+    return offset % sizeof(double) == 0 && offset <= size && length <= size - offset;
+}
+
+/**
+ * @brief Checks that every entry of an int array lies in [0, limit).
+ */
+static bool allBelow(const int *values, uint64_t count, int limit) {
+    for (uint64_t i = 0; i < count; i++) {
+        if (values[i] < 0 || values[i] >= limit) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks the ring offsets: increasing from 0 to numPoints, 3 vertices or more per ring.
+ */
+static bool validRings(const int *ringStart, int numRings, int numPoints) {
+    if (ringStart[0] != 0 || ringStart[numRings] != numPoints) return false;
+    for (int r = 0; r < numRings; r++) {
+        if (ringStart[r + 1] - ringStart[r] < 3) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Tells whether a scale factor of the grid or the slab index is usable.
+ */
+static bool validScale(double perUnit) {
+    return isfinite(perUnit) && perUnit > 0;
+}
+
+/**
+ * @brief Checks the box and the scale factors against the vertices: the box
+ * must be the bounding box of the points, as buildCellGrid() computes it, and
+ * the slab index must span its height.
+ */
+static bool validGeometry(const PolygonFileHeader *h, const Point *points) {
+    BoundingBox box = computeBoundingBox(points, h->numPoints);
+    if (!(h->box.minX < h->box.maxX && h->box.minY < h->box.maxY) ||
+        memcmp(&box, &h->box, sizeof(BoundingBox)) != 0 ||
+        !validScale(h->cellsPerUnitX) || !validScale(h->cellsPerUnitY)) {
+        return false;
+    }
+    return h->numSlabs == 0 ||
+           (validScale(h->slabsPerUnit) && h->slabMinY == box.minY && h->slabMaxY == box.maxY);
+}
+
+/**
+ * @brief Builds a model whose arrays point into a mapped binary polygon file.
+ *
+ * The header, the box, the scale factors and the slab offsets are validated,
+ * so a truncated or corrupt file is rejected instead of sending the kernels out of bounds.
+ * @param data Mapping of the whole file; on success the model owns it.
+ * @param size Size of the mapping.
+ * @param filename File name, for error messages.
+ * @param model Output model; release it with freePolygonModel().
+ * @return false if the file is invalid (the mapping is then released).
+ */
+bool attachPolygonFile(void *data, size_t size, const char *filename, PolygonModel *model) {
+    const PolygonFileHeader *h = data;
+    char *base = data;
+    // Os números das células são int: a grelha inteira tem de caber em INT_MAX
+    uint64_t numCells = (uint64_t)(h->gridCols > 0 ? h->gridCols : 0) * (h->gridRows > 0 ? h->gridRows : 0);
+
+    bool valid = h->version == POLYGON_FILE_VERSION && h->byteOrder == BYTE_ORDER_MARK &&
+                 h->fileSize == size && h->numPoints >= 3 && h->numEdges >= 0 &&
+                 h->numSlabs >= 0 &&
+                 (h->numSlabs > 0 ||
+                  (h->numSlabs == 0 && h->numEdges == 0 && h->numRings == 1 && h->convex != 0)) &&
+                 h->convex >= -1 && h->convex <= 1 &&
+                 h->numBoundaryCells > 0 && h->numInsideCells >= 0 &&
+                 h->gridCols > 0 && h->gridRows > 0 && numCells <= INT_MAX &&
+                 (uint64_t)h->numBoundaryCells + h->numInsideCells <= numCells &&
+                 sectionFits(h->boundaryCellsOffset, (uint64_t)h->numBoundaryCells * sizeof(int), size) &&
+                 sectionFits(h->pointsOffset, (uint64_t)h->numPoints * sizeof(Point), size) &&
+                 sectionFits(h->slabStartOffset, ((uint64_t)h->numSlabs + 1) * sizeof(int), size) &&
+                 sectionFits(h->edgeYLoOffset, (uint64_t)h->numEdges * sizeof(double), size) &&
+                 sectionFits(h->edgeYHiOffset, (uint64_t)h->numEdges * sizeof(double), size) &&
+                 sectionFits(h->edgeXOffset, (uint64_t)h->numEdges * sizeof(double), size) &&
+                 sectionFits(h->edgeSlopeOffset, (uint64_t)h->numEdges * sizeof(double), size) &&
+                 sectionFits(h->cellsOffset, numCells, size) &&
+                 h->numRings > 0 && h->numRegions > 0 &&
+                 sectionFits(h->ringStartOffset, ((uint64_t)h->numRings + 1) * sizeof(int), size) &&
+                 sectionFits(h->ringRegionOffset, (uint64_t)h->numRings * sizeof(int), size) &&
+                 sectionFits(h->regionAreaOffset, (uint64_t)h->numRegions * sizeof(double), size) &&
+                 (h->numRegions == 1 ||
+                  (sectionFits(h->edgeRegionOffset, (uint64_t)h->numEdges * sizeof(int), size) &&
+                   sectionFits(h->cellRegionOffset, numCells * sizeof(int), size)));
+
+    const int *slabStart = (const int *)(base + h->slabStartOffset);
+    if (valid) {
+        valid = validGeometry(h, (const Point *)(base + h->pointsOffset)) &&
+                slabStart[0] == 0 && slabStart[h->numSlabs] == h->numEdges;
+        for (int s = 0; valid && s < h->numSlabs; s++) {
+            valid = slabStart[s] <= slabStart[s + 1] && (slabStart[s + 1] - slabStart[s]) % SLAB_LANES == 0;
+        }
+        valid = valid && allBelow((const int *)(base + h->boundaryCellsOffset), h->numBoundaryCells, (int)numCells) &&
+                validRings((const int *)(base + h->ringStartOffset), h->numRings, h->numPoints) &&
+                allBelow((const int *)(base + h->ringRegionOffset), h->numRings, h->numRegions);
+        if (valid && h->numRegions > 1) {
+            valid = allBelow((const int *)(base + h->edgeRegionOffset), h->numEdges, h->numRegions) &&
+                    allBelow((const int *)(base + h->cellRegionOffset), numCells, h->numRegions);
+        }
+    }
+    if (!valid) {
+        fprintf(stderr, "%s: invalid or incompatible binary polygon file\n", filename);
+        munmap(data, size);
+        return false;
+    }
+
+    model->points = (Point *)(base + h->pointsOffset);
+    model->numPoints = h->numPoints;
+    model->numRings = h->numRings;
+    model->ringStart = (int *)(base + h->ringStartOffset);
+    model->ringRegion = (int *)(base + h->ringRegionOffset);
+    model->numRegions = h->numRegions;
+    model->regionArea = (double *)(base + h->regionAreaOffset);
+    model->convex = (ConvexPolygon){model->points, h->numPoints, h->convex};
+
+    model->index.minY = h->slabMinY;
+    model->index.maxY = h->slabMaxY;
+    model->index.slabsPerUnit = h->slabsPerUnit;
+    model->index.numSlabs = h->numSlabs;
+    model->index.slabStart = (int *)slabStart;
+    model->index.edgeYLo = (double *)(base + h->edgeYLoOffset);
+    model->index.edgeYHi = (double *)(base + h->edgeYHiOffset);
+    model->index.edgeX = (double *)(base + h->edgeXOffset);
+    model->index.edgeSlope = (double *)(base + h->edgeSlopeOffset);
+    model->index.edgeRegion = h->numRegions > 1 ? (int *)(base + h->edgeRegionOffset) : NULL;
+
+    model->grid.box = h->box;
+    model->grid.cols = h->gridCols;
+    model->grid.rows = h->gridRows;
+    model->grid.cellsPerUnitX = h->cellsPerUnitX;
+    model->grid.cellsPerUnitY = h->cellsPerUnitY;
+    model->grid.cells = (unsigned char *)(base + h->cellsOffset);
+    model->grid.index = &model->index;
+    model->grid.convex = h->numSlabs == 0 ? &model->convex : NULL;
+    model->grid.numRegions = h->numRegions;
+    model->grid.cellRegion = h->numRegions > 1 ? (int *)(base + h->cellRegionOffset) : NULL;
+    model->grid.numBoundaryCells = h->numBoundaryCells;
+    model->grid.boundaryCells = (int *)(base + h->boundaryCellsOffset);
+    model->grid.numInsideCells = h->numInsideCells;
+
+    model->domainArea = (h->box.maxX - h->box.minX) * (h->box.maxY - h->box.minY);
+    model->exactArea = h->exactArea;
+    model->mapping = data;
+    model->mappingSize = size;
+    return true;
+}
+
+/**
+ * @brief Writes a section at its offset, zero-padding the gap before it.
+ */
+static bool writeSection(FILE *out, uint64_t *position, uint64_t offset, const void *data, size_t length) {
+    static const char zeros[POLYGON_FILE_ALIGN];
+    if (fwrite(zeros, 1, offset - *position, out) != offset - *position) return false;
+    if (length > 0 && fwrite(data, 1, length, out) != length) return false;
+    *position = offset + length;
+    return true;
+}
+
+/**
+ * @brief Saves a model as a binary polygon file.
+ * @param filename Path of the file to write.
+ * @param model Model to save.
+ * @return false if the file could not be written.
+ */
+bool savePolygonFile(const char *filename, const PolygonModel *model) {
+    const SlabIndex *index = &model->index;
+    const CellGrid *grid = &model->grid;
+    int numEdges = index->slabStart[index->numSlabs];
+    size_t edgeBytes = (size_t)numEdges * sizeof(double);
+    PolygonFileHeader h;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, POLYGON_FILE_MAGIC, 8);
+    h.version = POLYGON_FILE_VERSION;
+    h.byteOrder = BYTE_ORDER_MARK;
+    h.numPoints = model->numPoints;
+    h.numSlabs = index->numSlabs;
+    h.numEdges = numEdges;
+    h.gridCols = grid->cols;
+    h.gridRows = grid->rows;
+    h.numRings = model->numRings;
+    h.numRegions = model->numRegions;
+    h.convex = model->convex.orientation;
+    h.numBoundaryCells = grid->numBoundaryCells;
+    h.numInsideCells = grid->numInsideCells;
+    h.box = grid->box;
+    h.exactArea = model->exactArea;
+    h.slabMinY = index->minY;
+    h.slabMaxY = index->maxY;
+    h.slabsPerUnit = index->slabsPerUnit;
+    h.cellsPerUnitX = grid->cellsPerUnitX;
+    h.cellsPerUnitY = grid->cellsPerUnitY;
+
+    h.pointsOffset = alignSection(sizeof(h));
+    h.slabStartOffset = alignSection(h.pointsOffset + (uint64_t)model->numPoints * sizeof(Point));
+    h.edgeYLoOffset = alignSection(h.slabStartOffset + ((uint64_t)index->numSlabs + 1) * sizeof(int));
+    h.edgeYHiOffset = alignSection(h.edgeYLoOffset + edgeBytes);
+    h.edgeXOffset = alignSection(h.edgeYHiOffset + edgeBytes);
+    h.edgeSlopeOffset = alignSection(h.edgeXOffset + edgeBytes);
+    h.cellsOffset = alignSection(h.edgeSlopeOffset + edgeBytes);
+    h.ringStartOffset = alignSection(h.cellsOffset + (uint64_t)grid->cols * grid->rows);
+    h.ringRegionOffset = alignSection(h.ringStartOffset + ((uint64_t)model->numRings + 1) * sizeof(int));
+    h.regionAreaOffset = alignSection(h.ringRegionOffset + (uint64_t)model->numRings * sizeof(int));
+    h.boundaryCellsOffset = alignSection(h.regionAreaOffset + (uint64_t)model->numRegions * sizeof(double));
+    h.fileSize = h.boundaryCellsOffset + (uint64_t)grid->numBoundaryCells * sizeof(int);
+    if (model->numRegions > 1) {
+        h.edgeRegionOffset = alignSection(h.fileSize);
+        h.cellRegionOffset = alignSection(h.edgeRegionOffset + (uint64_t)numEdges * sizeof(int));
+        h.fileSize = h.cellRegionOffset + (uint64_t)grid->cols * grid->rows * sizeof(int);
+    }
+
+    FILE *out = fopen(filename, "wb");
+    if (out == NULL) {
+        perror("Error creating the binary polygon file");
+        return false;
+    }
+
+    uint64_t position = 0;
+    bool ok = writeSection(out, &position, 0, &h, sizeof(h)) &&
+              writeSection(out, &position, h.pointsOffset, model->points, (size_t)model->numPoints * sizeof(Point)) &&
+              writeSection(out, &position, h.slabStartOffset, index->slabStart, ((size_t)index->numSlabs + 1) * sizeof(int)) &&
+              writeSection(out, &position, h.edgeYLoOffset, index->edgeYLo, edgeBytes) &&
+              writeSection(out, &position, h.edgeYHiOffset, index->edgeYHi, edgeBytes) &&
+              writeSection(out, &position, h.edgeXOffset, index->edgeX, edgeBytes) &&
+              writeSection(out, &position, h.edgeSlopeOffset, index->edgeSlope, edgeBytes) &&
+              writeSection(out, &position, h.cellsOffset, grid->cells, (size_t)grid->cols * grid->rows) &&
+              writeSection(out, &position, h.ringStartOffset, model->ringStart, ((size_t)model->numRings + 1) * sizeof(int)) &&
+              writeSection(out, &position, h.ringRegionOffset, model->ringRegion, (size_t)model->numRings * sizeof(int)) &&
+              writeSection(out, &position, h.regionAreaOffset, model->regionArea, (size_t)model->numRegions * sizeof(double)) &&
+              writeSection(out, &position, h.boundaryCellsOffset, grid->boundaryCells,
+                           (size_t)grid->numBoundaryCells * sizeof(int)) &&
+              (model->numRegions == 1 ||
+               (writeSection(out, &position, h.edgeRegionOffset, index->edgeRegion, (size_t)numEdges * sizeof(int)) &&
+                writeSection(out, &position, h.cellRegionOffset, grid->cellRegion,
+                             (size_t)grid->cols * grid->rows * sizeof(int))));
+    if (fclose(out) != 0) ok = false;
+
+    if (!ok) perror("Error writing the binary polygon file");
+    return ok;
+}
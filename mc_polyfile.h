@@ -0,0 +1,66 @@
+#ifndef MC_POLYFILE_H
+#define MC_POLYFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_polygon.h"
+
+#define POLYGON_FILE_MAGIC "MCPOLYGN"
+#define POLYGON_FILE_VERSION 5
+#define POLYGON_FILE_ALIGN 64
+
+/*
+ * Binary polygon file: a ready-to-use PolygonModel.
+ *
+ * The header is followed by the vertices (packed x, y doubles), the rings
+ * and regions, and every array of the slab index and cell grid (the region
+ * tags of edges and cells only with several regions), each section starting at a
+ * multiple of POLYGON_FILE_ALIGN bytes. Loading maps the file read-only and
+ * points the model's arrays into the mapping: nothing is parsed, copied or
+ * rebuilt, and forked workers share the page-cache pages of the file.
+ * Numbers are stored in the byte order of the machine that wrote the file;
+ * byteOrder rejects files from a machine of the other order.
+ */
+typedef struct {
+    char magic[8];          // POLYGON_FILE_MAGIC, not NUL-terminated
+    uint32_t version;
+    uint32_t byteOrder;     // 0x01020304 as written
+    uint64_t fileSize;
+    int32_t numPoints;
+    int32_t numSlabs;
+    int32_t numEdges;       // edge entries, padding included
+    int32_t gridCols;
+    int32_t gridRows;
+    int32_t numRings;
+    int32_t numRegions;
+    int32_t convex;         // orientation of a convex polygon, else 0
+    int32_t numBoundaryCells;
+    int32_t numInsideCells;
+    BoundingBox box;
+    double exactArea;
+    double slabMinY;
+    double slabMaxY;
+    double slabsPerUnit;
+    double cellsPerUnitX;
+    double cellsPerUnitY;
+    uint64_t pointsOffset;
+    uint64_t slabStartOffset;
+    uint64_t edgeYLoOffset;
+    uint64_t edgeYHiOffset;
+    uint64_t edgeXOffset;
+    uint64_t edgeSlopeOffset;
+    uint64_t cellsOffset;
+    uint64_t ringStartOffset;
+    uint64_t ringRegionOffset;
+    uint64_t regionAreaOffset;
+    uint64_t edgeRegionOffset;  // 0 with a single region
+    uint64_t cellRegionOffset;  // 0 with a single region
+    uint64_t boundaryCellsOffset;
+} PolygonFileHeader;
+
+bool isPolygonFile(const void *data, size_t size);
+bool attachPolygonFile(void *data, size_t size, const char *filename, PolygonModel *model);
+bool savePolygonFile(const char *filename, const PolygonModel *model);
+
+#endif
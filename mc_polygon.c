@@ -0,0 +1,475 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mc_polycache.h"
+#include "mc_polyfile.h"
+#include "mc_polygon.h"
+
+#define INITIAL_CAPACITY 1024
+#define MAX_NUMBER_LENGTH 512
+
+// Potências de 10 representáveis exatamente num double
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief Parses a decimal number ("-0.5", "1e-3", ...) from a buffer that is
+ * not NUL-terminated.
+ *
+ * Up to 19 significant digits are gathered in an integer. When that integer
+ * and the power of ten are both exact doubles, one multiplication or
+ * division gives the correctly rounded result; any other number is handed
+ * to strtod, so the result always equals strtod's.
+ * @param cursor Position to parse from; moved past the number.
+ * @param end End of the buffer.
+ * @param value Output: the number.
+ * @return false if there is no number at the cursor.
+ */
+static bool parseDouble(const char **cursor, const char *end, double *value) {
+    const char *p = *cursor, *start = p;
+    bool negative = false, anyDigit = false;
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        anyDigit = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            anyDigit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!anyDigit) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negativeExp = false;
+        int power = 0;
+        if (q < end && (*q == '-' || *q == '+')) negativeExp = *q++ == '-';
+        if (q < end && *q >= '0' && *q <= '9') {
+            for (; q < end && *q >= '0' && *q <= '9'; q++) {
+                if (power < 100000) power = power * 10 + (*q - '0');
+            }
+            exponent += negativeExp ? -power : power;
+            p = q;
+        }
+    }
+
+    if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double v = exponent < 0 ? mantissa / POW10[-exponent] : mantissa * POW10[exponent];
+        *value = negative ? -v : v;
+    } else {
+        // Caso raro: strtod precisa de uma cópia terminada em '\0'
+        char text[MAX_NUMBER_LENGTH];
+        size_t length = p - start;
+        if (length >= sizeof(text)) return false;
+        memcpy(text, start, length);
+        text[length] = '\0';
+        *value = strtod(text, NULL);
+    }
+
+    *cursor = p;
+    return true;
+}
+
+/**
+ * @brief Skips spaces, tabs and carriage returns, but not newlines.
+ */
+static const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+/*
+ * Vertices and rings read from a polygon text file, all malloc'ed.
+ */
+typedef struct {
+    Point *points;
+    int numPoints;
+    int *ringStart;     // numRings + 1 entries
+    int *ringRegion;
+    int numRings;
+    int numRegions;
+} PolygonText;
+
+/**
+ * @brief Doubles the capacity of an array when it is full.
+ * @return false if memory runs out (the array is left unchanged).
+ */
+static bool reserve(void **array, int *capacity, int count, size_t size) {
+    if (count < *capacity) return true;
+
+    int grown = *capacity ? 2 * *capacity : INITIAL_CAPACITY;
+    void *larger = realloc(*array, (size_t)grown * size);
+    if (larger == NULL) return false;
+    *array = larger;
+    *capacity = grown;
+    return true;
+}
+
+static void freePolygonText(PolygonText *parsed) {
+    free(parsed->points);
+    free(parsed->ringStart);
+    free(parsed->ringRegion);
+}
+
+/**
+ * @brief Ends the ring being read, if any.
+ * @return false if the ring has fewer than 3 vertices.
+ */
+static bool closeRing(PolygonText *parsed, int *openStart, const char *filename, int line) {
+    if (*openStart < 0) return true;
+    if (parsed->numPoints - *openStart < 3) {
+        fprintf(stderr, "%s:%d: a ring needs at least 3 points\n", filename, line);
+        return false;
+    }
+    *openStart = -1;
+    return true;
+}
+
+/**
+ * @brief Parses the "x,y," lines of a polygon text buffer in one pass.
+ *
+ * A file holds one ring, as always, or several: an empty line ends a ring
+ * and the next point starts another one of the same region, and a line
+ * starting with '>' (as in GMT multi-segment files) starts a new region;
+ * the rest of that line is ignored. Within a region the even-odd rule
+ * applies, so a ring inside another one is a hole.
+ * @param text Contents of the file.
+ * @param end End of the contents.
+ * @param filename File name, for error messages.
+ * @param parsed Output: the vertices and rings; release with freePolygonText().
+ * @return false on a malformed line or if memory runs out.
+ */
+static bool parsePolygonText(const char *text, const char *end, const char *filename, PolygonText *parsed) {
+    int capacity = 0, startCapacity = 0, regionCapacity = 0, line = 1, openStart = -1, region = 0;
+    bool ok = true;
+
+    memset(parsed, 0, sizeof(*parsed));
+    for (const char *p = text; ok && p < end; line++) {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '>') {
+            ok = closeRing(parsed, &openStart, filename, line);
+            if (parsed->numRings > 0 && parsed->ringRegion[parsed->numRings - 1] == region) region++;
+            while (p < end && *p != '\n') p++;
+            if (p < end) p++;
+            continue;
+        }
+        if (p == end || *p == '\n') {
+            ok = closeRing(parsed, &openStart, filename, line);
+            if (p < end) p++;
+            continue;
+        }
+
+        Point v;
+        ok = parseDouble(&p, end, &v.x);
+        p = skipBlanks(p, end);
+        if (ok && p < end && *p == ',') p = skipBlanks(p + 1, end);
+        ok = ok && parseDouble(&p, end, &v.y);
+        // Resto da linha: só separadores (os ficheiros terminam cada linha em ',')
+        while (ok && p < end && (*p == ',' || *p == ' ' || *p == '\t' || *p == '\r')) p++;
+        if (!ok || (p < end && *p != '\n')) {
+            fprintf(stderr, "%s:%d: expected \"x,y\"\n", filename, line);
+            ok = false;
+            break;
+        }
+        if (p < end) p++;
+
+        // ringStart guarda sempre uma entrada a mais, para o fim do último anel
+        ok = reserve((void **)&parsed->points, &capacity, parsed->numPoints, sizeof(Point)) &&
+             (openStart >= 0 ||
+              (reserve((void **)&parsed->ringStart, &startCapacity, parsed->numRings + 1, sizeof(int)) &&
+               reserve((void **)&parsed->ringRegion, &regionCapacity, parsed->numRings, sizeof(int))));
+        if (!ok) {
+            fprintf(stderr, "Out of memory loading %s\n", filename);
+            break;
+        }
+        if (openStart < 0) {
+            openStart = parsed->numPoints;
+            parsed->ringStart[parsed->numRings] = openStart;
+            parsed->ringRegion[parsed->numRings++] = region;
+        }
+        parsed->points[parsed->numPoints++] = v;
+        parsed->ringStart[parsed->numRings] = parsed->numPoints;
+    }
+
+    ok = ok && closeRing(parsed, &openStart, filename, line);
+    if (!ok) {
+        freePolygonText(parsed);
+        return false;
+    }
+    parsed->numRegions = parsed->numRings > 0 ? parsed->ringRegion[parsed->numRings - 1] + 1 : 0;
+    return true;
+}
+
+/**
+ * @brief Maps a whole file read-only.
+ * @param filename Path of the file.
+ * @param data Output: the mapping, or NULL for an empty file.
+ * @param size Output: size of the file.
+ * @return false if the file cannot be opened or mapped.
+ */
+static bool mapFile(const char *filename, void **data, size_t *size) {
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        perror("Error opening the polygon file");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("Error reading the polygon file");
+        close(fd);
+        return false;
+    }
+
+    *data = NULL;
+    *size = st.st_size;
+    if (*size > 0) {
+        // MAP_SHARED: os processos filhos usam as mesmas páginas da cache
+        *data = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+        if (*data == MAP_FAILED) {
+            perror("Error mapping the polygon file");
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+    return true;
+}
+
+/**
+ * @brief Loads the vertices of a polygon file of "x,y," lines.
+ *
+ * The file is mapped into memory and parsed in a single pass, without a
+ * read() or lseek() per vertex, and the vertex array grows as needed. The
+ * vertices of every ring are returned one after the other.
+ * @param filename Path of the polygon file.
+ * @param points Output: malloc'ed array of vertices, to be freed by the caller.
+ * @param numPoints Output: number of vertices.
+ * @return false if the file cannot be read or is malformed.
+ */
+bool loadPolygon(const char *filename, Point **points, int *numPoints) {
+    void *text;
+    size_t size;
+    PolygonText parsed;
+
+    *points = NULL;
+    *numPoints = 0;
+    if (!mapFile(filename, &text, &size)) return false;
+    if (size == 0) return true;
+
+    madvise(text, size, MADV_SEQUENTIAL);
+    bool ok = parsePolygonText(text, (const char *)text + size, filename, &parsed);
+    munmap(text, size);
+    if (!ok) return false;
+
+    *points = parsed.points;
+    *numPoints = parsed.numPoints;
+    free(parsed.ringStart);
+    free(parsed.ringRegion);
+    return true;
+}
+
+/**
+ * @brief Loads a polygon and makes it ready for sampling.
+ *
+ * Binary polygon files are used in place. Text files are looked up in the
+ * polygon cache first; on a miss they are parsed, indexed with
+ * buildRegionsModel() and stored in the cache for the next run.
+ * @param filename Path of a text or binary polygon file.
+ * @param model Output model; release it with freePolygonModel().
+ * @return false if the file cannot be loaded or has no ring.
+ */
+bool loadPolygonModel(const char *filename, PolygonModel *model) {
+    void *data;
+    size_t size;
+
+    if (!mapFile(filename, &data, &size)) return false;
+    if (isPolygonFile(data, size)) return attachPolygonFile(data, size, filename, model);
+
+    char entry[POLYGON_CACHE_ENTRY_MAX];
+    bool cached = size > 0 && polygonCacheEntry(data, size, entry, sizeof(entry));
+    if (cached && attachCachedPolygon(entry, model)) {
+        munmap(data, size);
+        return true;
+    }
+
+    PolygonText parsed = {NULL, 0, NULL, NULL, 0, 0};
+    bool ok = size == 0 || parsePolygonText(data, (const char *)data + size, filename, &parsed);
+    if (size > 0) munmap(data, size);
+    if (!ok) return false;
+
+    if (parsed.numRings == 0) {
+        fprintf(stderr, "The polygon must have at least 3 points\n");
+        freePolygonText(&parsed);
+        return false;
+    }
+    if (!buildRegionsModel(parsed.points, parsed.ringStart, parsed.ringRegion, parsed.numRings,
+                           parsed.numRegions, model)) {
+        fprintf(stderr, "Failed to build the polygon index\n");
+        return false;
+    }
+    if (cached) storeCachedPolygon(entry, model);
+    return true;
+}
+
+/**
+ * @brief Crossing-number test of a point against one closed ring.
+ */
+static bool ringContains(const Point ring[], int n, Point p) {
+    bool inside = false;
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        if ((ring[i].y > p.y) != (ring[j].y > p.y) &&
+            p.x < ring[j].x + (p.y - ring[j].y) * (ring[i].x - ring[j].x) / (ring[i].y - ring[j].y)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/**
+ * @brief Computes the even-odd area of every region: each ring adds its
+ * shoelace area when it is nested in an even number of rings of its region
+ * and subtracts it otherwise, so holes and islands in holes are exact as
+ * long as rings do not cross.
+ * @return false if memory could not be allocated.
+ */
+static bool computeRegionAreas(PolygonModel *model) {
+    const Point *points = model->points;
+    const int *start = model->ringStart;
+    BoundingBox *boxes = malloc(model->numRings * sizeof(BoundingBox));
+    model->regionArea = calloc(model->numRegions, sizeof(double));
+    if (boxes == NULL || model->regionArea == NULL) {
+        free(boxes);
+        return false;
+    }
+
+    for (int r = 0; r < model->numRings; r++) {
+        boxes[r] = computeBoundingBox(points + start[r], start[r + 1] - start[r]);
+    }
+
+    model->exactArea = 0;
+    for (int r = 0; r < model->numRings; r++) {
+        Point first = points[start[r]];
+        int depth = 0;
+        for (int q = 0; q < model->numRings; q++) {
+            // Caixas primeiro: o teste exato só corre para anéis que podem conter este
+            if (q == r || model->ringRegion[q] != model->ringRegion[r] || boxes[q].minX > boxes[r].minX ||
+                boxes[q].maxX < boxes[r].maxX || boxes[q].minY > boxes[r].minY || boxes[q].maxY < boxes[r].maxY) {
+                continue;
+            }
+            depth += ringContains(points + start[q], start[q + 1] - start[q], first);
+        }
+
+        double area = shoelaceArea(points + start[r], start[r + 1] - start[r]);
+        model->regionArea[model->ringRegion[r]] += depth % 2 ? -area : area;
+        model->exactArea += depth % 2 ? -area : area;
+    }
+
+    free(boxes);
+    return true;
+}
+
+/**
+ * @brief Builds the slab index and cell grid of a polygon with a single ring.
+ * @param points malloc'ed vertices of the polygon; the model takes ownership.
+ * @param numPoints Number of vertices (at least 3).
+ * @param model Output model; release it with freePolygonModel().
+ * @return false if memory could not be allocated (points is then freed).
+ */
+bool buildPolygonModel(Point *points, int numPoints, PolygonModel *model) {
+    int *ringStart = malloc(2 * sizeof(int));
+    int *ringRegion = malloc(sizeof(int));
+    if (ringStart == NULL || ringRegion == NULL) {
+        free(points);
+        free(ringStart);
+        free(ringRegion);
+        return false;
+    }
+
+    ringStart[0] = 0;
+    ringStart[1] = numPoints;
+    ringRegion[0] = 0;
+    return buildRegionsModel(points, ringStart, ringRegion, 1, 1, model);
+}
+
+/**
+ * @brief Builds the shared slab index and cell grid of a set of rings
+ * grouped in regions.
+ * @param points malloc'ed vertices of all rings, ring after ring.
+ * @param ringStart malloc'ed numRings + 1 offsets: ring r is points[ringStart[r] .. ringStart[r + 1]).
+ * @param ringRegion malloc'ed region of each ring, in [0, numRegions).
+ * @param numRings Number of rings (each with at least 3 vertices).
+ * @param numRegions Number of regions.
+ * @param model Output model, owning the three arrays; release it with freePolygonModel().
+ * @return false for a degenerate shape or if memory could not be allocated
+ * (the arrays are then freed).
+ */
+bool buildRegionsModel(Point *points, int *ringStart, int *ringRegion, int numRings, int numRegions,
+                       PolygonModel *model) {
+    memset(model, 0, sizeof(*model));
+    model->points = points;
+    model->numPoints = ringStart[numRings];
+    model->numRings = numRings;
+    model->ringStart = ringStart;
+    model->ringRegion = ringRegion;
+    model->numRegions = numRegions;
+
+    // Polígono convexo grande: o teste em leque dispensa o índice por faixas
+    if (numRings == 1) {
+        model->convex = (ConvexPolygon){points, model->numPoints, convexOrientation(points, model->numPoints)};
+    }
+    bool fan = model->convex.orientation != 0 && model->numPoints >= CONVEX_FAN_MIN_VERTICES;
+    bool indexed = fan ? (model->index.slabStart = calloc(1, sizeof(int))) != NULL
+                       : buildSlabIndex(points, ringStart, numRings, numRegions > 1 ? ringRegion : NULL, &model->index);
+
+    if (!indexed ||
+        !buildCellGrid(points, ringStart, numRings, numRegions, &model->index, fan ? &model->convex : NULL,
+                       &model->grid) ||
+        !computeRegionAreas(model)) {
+        freePolygonModel(model);
+        return false;
+    }
+
+    BoundingBox box = model->grid.box;
+    model->domainArea = (box.maxX - box.minX) * (box.maxY - box.minY);
+    return true;
+}
+
+/**
+ * @brief Releases a model loaded by loadPolygonModel() or built by buildRegionsModel().
+ * @param model Model to release.
+ */
+void freePolygonModel(PolygonModel *model) {
+    if (model->mapping != NULL) {
+        munmap(model->mapping, model->mappingSize);
+        return;
+    }
+    freeCellGrid(&model->grid);
+    freeSlabIndex(&model->index);
+    free(model->points);
+    free(model->ringStart);
+    free(model->ringRegion);
+    free(model->regionArea);
+}
@@ -0,0 +1,59 @@
+#ifndef MC_POLYGON_H
+#define MC_POLYGON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "mc_geometry.h"
+#include "mc_grid.h"
+#include "mc_slab.h"
+
+#define CONVEX_FAN_MIN_VERTICES 65536   // convex polygons this large get no slab index
+
+/*
+ * Everything the samplers need to know about one polygon, built once by the
+ * parent before any worker starts. Forked children inherit it and threads
+ * share it read-only. Points are always drawn from the bounding box of the
+ * polygon, which is also the grid's extent.
+ *
+ * A model comes either from a text file, parsed and indexed at load time,
+ * or from a binary polygon file (mc_polyfile.h) whose arrays are used in
+ * place from a read-only shared mapping. Text files already seen are
+ * served from the binary files of the polygon cache (mc_polycache.h).
+ *
+ * A model may hold several rings grouped in regions (a polygon with holes
+ * is one region of several rings; a multipolygon is several regions). All
+ * rings share one slab index and one grid, so a sample is tested against
+ * every region in a single lookup. With several regions, "inside" means
+ * inside some region, and exactArea assumes the regions do not overlap.
+ *
+ * Convexity is detected at load time. A large convex polygon (a single
+ * ring of CONVEX_FAN_MIN_VERTICES or more) gets no slab index: its boundary
+ * cells use the O(log n) fan test of convex, which needs no memory beyond
+ * the vertices. Below that size the slab index is cheap to build and its
+ * O(1) test is faster, so it is kept.
+ */
+typedef struct {
+    Point *points;      // vertices in file order, ring after ring
+    int numPoints;
+    int numRings;
+    int *ringStart;     // ring r is points[ringStart[r] .. ringStart[r + 1])
+    int *ringRegion;    // region of each ring
+    int numRegions;
+    double *regionArea; // exact even-odd area of each region
+    ConvexPolygon convex; // orientation 0 unless the model is one convex ring
+    SlabIndex index;    // empty (numSlabs 0) for a large convex polygon
+    CellGrid grid;
+    double domainArea;  // area of grid.box
+    double exactArea;   // sum of regionArea
+    void *mapping;      // binary file holding the arrays, or NULL if they are malloc'ed
+    size_t mappingSize;
+} PolygonModel;
+
+bool loadPolygon(const char *filename, Point **points, int *numPoints);
+bool loadPolygonModel(const char *filename, PolygonModel *model);
+bool buildPolygonModel(Point *points, int numPoints, PolygonModel *model);
+bool buildRegionsModel(Point *points, int *ringStart, int *ringRegion, int numRings, int numRegions,
+                       PolygonModel *model);
+void freePolygonModel(PolygonModel *model);
+
+#endif
@@ -0,0 +1,133 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mc_pool.h"
+#include "mc_progress.h"
+
+#define RANGE(begin, end) (((uint64_t)(begin) << 32) | (uint32_t)(end))
+#define RANGE_BEGIN(r) ((long)((r) >> 32))
+#define RANGE_END(r) ((long)((r) & 0xffffffffu))
+
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic uint64_t range;
+} WorkRange;
+
+typedef struct {
+    WorkRange *ranges;
+    int workers;
+    ChunkFn fn;
+    void *ctx;
+    long *results;
+} PoolShared;
+
+typedef struct {
+    PoolShared *shared;
+    int id;
+} PoolWorker;
+
+/**
+ * @brief Takes the first chunk of a worker's own range.
+ * @return The chunk number, or -1 if the range is empty.
+ */
+static long popChunk(WorkRange *own) {
+    uint64_t r = atomic_load(&own->range);
+    while (RANGE_BEGIN(r) < RANGE_END(r)) {
+        if (atomic_compare_exchange_weak(&own->range, &r, RANGE(RANGE_BEGIN(r) + 1, RANGE_END(r)))) {
+            return RANGE_BEGIN(r);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Moves the back half of a victim's range into the thief's range.
+ * @return true if at least one chunk was stolen.
+ */
+static bool stealChunks(WorkRange *victim, WorkRange *thief) {
+    uint64_t r = atomic_load(&victim->range);
+    while (RANGE_BEGIN(r) < RANGE_END(r)) {
+        long begin = RANGE_BEGIN(r), end = RANGE_END(r);
+        long half = (end - begin + 1) / 2;
+        if (atomic_compare_exchange_weak(&victim->range, &r, RANGE(begin, end - half))) {
+            atomic_store(&thief->range, RANGE(end - half, end));
+            return true;
+        }
+    }
+    return false;
+}
+
+static void *poolWorker(void *arg) {
+    PoolWorker *self = arg;
+    PoolShared *shared = self->shared;
+    WorkRange *own = &shared->ranges[self->id];
+
+    for (;;) {
+        long chunk = popChunk(own);
+        if (chunk >= 0) {
+            long result = shared->fn(shared->ctx, chunk, self->id);
+            if (shared->results) shared->results[chunk] = result;
+            continue;
+        }
+
+        // Sem trabalho próprio: roubar, começando pelo vizinho seguinte
+        bool stolen = false;
+        for (int k = 1; k < shared->workers && !stolen; k++) {
+            stolen = stealChunks(&shared->ranges[(self->id + k) % shared->workers], own);
+        }
+        if (!stolen) break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Returns the number of online CPUs (at least 1).
+ */
+int defaultWorkerCount(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+/**
+ * @brief Runs fn on every chunk in [0, chunks) with a pool of threads.
+ * @param workers Number of threads.
+ * @param chunks Number of chunks (less than 2^32).
+ * @param fn Function applied to each chunk.
+ * @param ctx Context passed to fn.
+ * @param results Optional array of chunks entries receiving each fn result.
+ * @return false if the threads could not be started.
+ */
+bool runWorkPool(int workers, long chunks, ChunkFn fn, void *ctx, long *results) {
+    WorkRange *ranges = aligned_alloc(CACHE_LINE, workers * sizeof(WorkRange));
+    pthread_t *threads = malloc(workers * sizeof(pthread_t));
+    PoolWorker *args = malloc(workers * sizeof(PoolWorker));
+    if (ranges == NULL || threads == NULL || args == NULL) {
+        free(ranges);
+        free(threads);
+        free(args);
+        return false;
+    }
+
+    PoolShared shared = {ranges, workers, fn, ctx, results};
+    for (int i = 0; i < workers; i++) {
+        atomic_init(&ranges[i].range, RANGE(chunks * i / workers, chunks * (i + 1) / workers));
+    }
+
+    int started = 0;
+    for (; started < workers; started++) {
+        args[started].shared = &shared;
+        args[started].id = started;
+        if (pthread_create(&threads[started], NULL, poolWorker, &args[started]) != 0) break;
+    }
+    // Se faltarem threads, as que arrancaram roubam o trabalho das restantes
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(ranges);
+    free(threads);
+    free(args);
+    return started > 0;
+}
@@ -0,0 +1,29 @@
+#ifndef MC_POOL_H
+#define MC_POOL_H
+
+#include <stdbool.h>
+
+/*
+ * Work-stealing pool of threads over a fixed number of chunks.
+ *
+ * The chunks are first split evenly: each worker owns a contiguous range
+ * of chunk numbers and takes chunks from its front. A worker whose range
+ * is empty steals the back half of another worker's range, so a slow or
+ * descheduled thread never leaves the others idle at the end of a run.
+ * Ranges are packed in one 64-bit atomic word per worker, on its own cache
+ * line, and updated with compare-and-swap only.
+ */
+
+/**
+ * @brief Processes one chunk.
+ * @param ctx Context given to runWorkPool().
+ * @param chunk Chunk number, in [0, chunks).
+ * @param worker Number of the worker running the chunk, in [0, workers).
+ * @return The chunk's result (e.g. the number of samples inside).
+ */
+typedef long (*ChunkFn)(void *ctx, long chunk, int worker);
+
+int defaultWorkerCount(void);
+bool runWorkPool(int workers, long chunks, ChunkFn fn, void *ctx, long *results);
+
+#endif
@@ -0,0 +1,66 @@
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "mc_progress.h"
+
+/**
+ * @brief Allocates one zeroed, cache-line aligned counter per worker.
+ * @param workers Number of workers.
+ * @return The counters, or NULL if memory could not be allocated.
+ */
+WorkerCounter *createCounters(int workers) {
+    WorkerCounter *counters = aligned_alloc(CACHE_LINE, workers * sizeof(WorkerCounter));
+    if (counters == NULL) return NULL;
+
+    for (int i = 0; i < workers; i++) {
+        atomic_init(&counters[i].done, 0);
+        atomic_init(&counters[i].hits, 0);
+    }
+    return counters;
+}
+
+/**
+ * @brief Releases counters allocated by createCounters().
+ * @param counters Counters to release.
+ */
+void destroyCounters(WorkerCounter *counters) {
+    free(counters);
+}
+
+/**
+ * @brief Allocates zeroed counters in anonymous shared memory, so forked
+ * workers and their parent see the same counters.
+ * @param workers Number of workers.
+ * @return The counters, or NULL if the mapping failed.
+ */
+WorkerCounter *createSharedCounters(int workers) {
+    // mmap devolve páginas alinhadas e a zero: cada contador fica na sua linha
+    WorkerCounter *counters = mmap(NULL, workers * sizeof(WorkerCounter), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return counters == MAP_FAILED ? NULL : counters;
+}
+
+/**
+ * @brief Releases counters allocated by createSharedCounters().
+ * @param counters Counters to release.
+ * @param workers Number of workers they were created for.
+ */
+void destroySharedCounters(WorkerCounter *counters, int workers) {
+    munmap(counters, workers * sizeof(WorkerCounter));
+}
+
+/**
+ * @brief Sums the counters of every worker.
+ * @param counters Counters to read.
+ * @param workers Number of workers.
+ * @param hits Optional output (may be NULL): total samples inside.
+ * @return Total samples published so far.
+ */
+long sumCounters(WorkerCounter *counters, int workers, long *hits) {
+    long total = 0, inside = 0;
+    for (int i = 0; i < workers; i++) {
+        total += atomic_load_explicit(&counters[i].done, memory_order_relaxed);
+        inside += atomic_load_explicit(&counters[i].hits, memory_order_relaxed);
+    }
+    if (hits) *hits = inside;
+    return total;
+}
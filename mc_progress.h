@@ -0,0 +1,39 @@
+#ifndef MC_PROGRESS_H
+#define MC_PROGRESS_H
+
+#include <stdatomic.h>
+
+#define CACHE_LINE 64
+
+/*
+ * Per-worker progress counter (samples done and samples inside), alone on
+ * its cache line. Each worker is the only writer of its counter and
+ * publishes once per batch with relaxed stores, so workers never contend;
+ * the progress display sums all counters on its own schedule. Forked
+ * workers use the same counters in anonymous shared memory.
+ */
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_long done;
+    atomic_long hits;
+} WorkerCounter;
+
+WorkerCounter *createCounters(int workers);
+void destroyCounters(WorkerCounter *counters);
+WorkerCounter *createSharedCounters(int workers);
+void destroySharedCounters(WorkerCounter *counters, int workers);
+long sumCounters(WorkerCounter *counters, int workers, long *hits);
+
+/**
+ * @brief Publishes a finished batch. Only the owning worker may call this.
+ * @param counter Counter of the calling worker.
+ * @param samples Number of samples in the batch.
+ * @param hits Number of those samples inside the polygon.
+ */
+static inline void counterAdd(WorkerCounter *counter, long samples, long hits) {
+    long current = atomic_load_explicit(&counter->hits, memory_order_relaxed);
+    atomic_store_explicit(&counter->hits, current + hits, memory_order_relaxed);
+    current = atomic_load_explicit(&counter->done, memory_order_relaxed);
+    atomic_store_explicit(&counter->done, current + samples, memory_order_relaxed);
+}
+
+#endif
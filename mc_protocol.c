@@ -0,0 +1,98 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "mc_backend.h"
+#include "mc_protocol.h"
+
+_Static_assert(offsetof(RecordWriter, points) == offsetof(RecordWriter, header) + sizeof(ResultRecord),
+               "the points of a record must follow its header");
+
+/**
+ * @brief Prepares an empty record for a worker.
+ * @param writer Writer to initialize.
+ * @param fd Descriptor the records are written to.
+ * @param worker Worker number.
+ */
+void initRecordWriter(RecordWriter *writer, int fd, int worker) {
+    writer->fd = fd;
+    writer->header.magic = RECORD_MAGIC;
+    writer->header.worker = worker;
+    writer->header.samples = 0;
+    writer->header.hits = 0;
+    writer->header.numPoints = 0;
+    writer->header.flags = 0;
+}
+
+/**
+ * @brief Appends a point to the record, sending the record first if it is full.
+ * @return false if sending failed.
+ */
+bool recordPoint(RecordWriter *writer, Point p) {
+    if (writer->header.numPoints == RECORD_MAX_POINTS && !flushRecord(writer, false)) return false;
+    writer->points[writer->header.numPoints++] = p;
+    return true;
+}
+
+/**
+ * @brief Sends the pending counts and points as one record, in one write.
+ * @param writer Writer of the worker.
+ * @param final true for the worker's last record.
+ * @return false if the write failed.
+ */
+bool flushRecord(RecordWriter *writer, bool final) {
+    size_t length = sizeof(ResultRecord) + writer->header.numPoints * sizeof(Point);
+    writer->header.flags = final ? RECORD_FINAL : 0;
+
+    bool ok = writen(writer->fd, &writer->header, length) == (ssize_t)length;
+    writer->header.samples = 0;
+    writer->header.hits = 0;
+    writer->header.numPoints = 0;
+    return ok;
+}
+
+/**
+ * @brief Decodes one record from the start of a byte buffer, as filled by
+ * non-blocking reads that may stop anywhere inside a record.
+ * @param data Bytes received so far.
+ * @param length Number of bytes in data.
+ * @param record Output header.
+ * @param points Output array of at least RECORD_MAX_POINTS entries.
+ * @return Bytes taken by the record, 0 if it is still incomplete, -1 if it is corrupt.
+ */
+long parseRecord(const void *data, size_t length, ResultRecord *record, Point *points) {
+    if (length < sizeof(*record)) return 0;
+
+    memcpy(record, data, sizeof(*record));
+    if (record->magic != RECORD_MAGIC || record->numPoints > RECORD_MAX_POINTS) {
+        fprintf(stderr, "Corrupt result record\n");
+        return -1;
+    }
+
+    size_t total = sizeof(*record) + record->numPoints * sizeof(Point);
+    if (length < total) return 0;
+    memcpy(points, (const char *)data + sizeof(*record), total - sizeof(*record));
+    return total;
+}
+
+/**
+ * @brief Reads one record and its points.
+ * @param fd Descriptor to read from.
+ * @param record Output header.
+ * @param points Output array of at least RECORD_MAX_POINTS entries.
+ * @return 1 for a record, 0 at end of file, -1 on a read error or a corrupt record.
+ */
+int readRecord(int fd, ResultRecord *record, Point *points) {
+    ssize_t got = readn(fd, record, sizeof(*record));
+    if (got == 0) return 0;
+    if (got != sizeof(*record) || record->magic != RECORD_MAGIC || record->numPoints > RECORD_MAX_POINTS) {
+        fprintf(stderr, "Corrupt result record\n");
+        return -1;
+    }
+
+    size_t length = record->numPoints * sizeof(Point);
+    if (length > 0 && readn(fd, points, length) != (ssize_t)length) {
+        fprintf(stderr, "Truncated result record\n");
+        return -1;
+    }
+    return 1;
+}
@@ -0,0 +1,63 @@
+#ifndef MC_PROTOCOL_H
+#define MC_PROTOCOL_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mc_geometry.h"
+
+#define RECORD_MAGIC 0x4d435231u    // "MCR1"
+#define RECORD_FINAL 1u
+#define RECORD_HEADER_SIZE 32
+#define RECORD_MAX_POINTS ((PIPE_BUF - RECORD_HEADER_SIZE) / sizeof(Point))
+#define RECORD_MAX_SIZE (RECORD_HEADER_SIZE + RECORD_MAX_POINTS * sizeof(Point))
+
+/*
+ * Binary result records sent by forked workers to the parent.
+ *
+ * A record is a fixed 32-byte header optionally followed by numPoints
+ * coordinates. samples and hits are increments since the worker's previous
+ * record, so the parent only sums them; the last record of a worker carries
+ * RECORD_FINAL. A whole record is at most PIPE_BUF bytes and is sent with a
+ * single write, so records from workers sharing one pipe never interleave.
+ */
+typedef struct {
+    uint32_t magic;
+    int32_t worker;
+    int64_t samples;
+    int64_t hits;
+    uint32_t numPoints;
+    uint32_t flags;
+} ResultRecord;
+
+_Static_assert(sizeof(ResultRecord) == RECORD_HEADER_SIZE, "ResultRecord must stay 32 bytes");
+
+/*
+ * Accumulates the results of one worker and sends them as records: points
+ * are buffered until the record is full, counts until the next flush.
+ */
+typedef struct {
+    int fd;
+    ResultRecord header;
+    Point points[RECORD_MAX_POINTS];  // must directly follow header
+} RecordWriter;
+
+void initRecordWriter(RecordWriter *writer, int fd, int worker);
+bool recordPoint(RecordWriter *writer, Point p);
+bool flushRecord(RecordWriter *writer, bool final);
+int readRecord(int fd, ResultRecord *record, Point *points);
+long parseRecord(const void *data, size_t length, ResultRecord *record, Point *points);
+
+/**
+ * @brief Adds sampled counts to the next record.
+ * @param writer Writer of the worker.
+ * @param samples Samples drawn.
+ * @param hits Samples inside.
+ */
+static inline void recordCounts(RecordWriter *writer, long samples, long hits) {
+    writer->header.samples += samples;
+    writer->header.hits += hits;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_ring.h"
+
+/**
+ * @brief Creates one ring per worker in a POSIX shared memory object.
+ *
+ * The object is unlinked right away: the mapping survives, is inherited by
+ * the children through fork and disappears with the last process using it.
+ * @param workers Number of rings.
+ * @return The ring set, or NULL on failure.
+ */
+RingSet *createRingSet(int workers) {
+    char name[64];
+    snprintf(name, sizeof(name), "/mc_rings_%d", (int)getpid());
+
+    size_t size = sizeof(RingSet) + workers * sizeof(PointRing);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        perror("shm_open failed");
+        return NULL;
+    }
+    shm_unlink(name);
+
+    if (ftruncate(fd, size) == -1) {
+        perror("ftruncate failed");
+        close(fd);
+        return NULL;
+    }
+    RingSet *set = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (set == MAP_FAILED) {
+        perror("mmap failed");
+        return NULL;
+    }
+
+    // ftruncate já deixou tudo a zero; falta iniciar os semáforos partilhados
+    set->workers = workers;
+    set->size = size;
+    sem_init(&set->dataReady, 1, 0);
+    for (int i = 0; i < workers; i++) sem_init(&set->rings[i].space, 1, 0);
+    return set;
+}
+
+/**
+ * @brief Releases a ring set created by createRingSet().
+ */
+void destroyRingSet(RingSet *set) {
+    for (int i = 0; i < set->workers; i++) sem_destroy(&set->rings[i].space);
+    sem_destroy(&set->dataReady);
+    munmap(set, set->size);
+}
+
+/**
+ * @brief Wakes the parent if it is sleeping on the set. Called after publishing.
+ */
+static void wakeConsumer(RingSet *set) {
+    if (atomic_load(&set->consumerWaiting) && atomic_exchange(&set->consumerWaiting, 0)) {
+        sem_post(&set->dataReady);
+    }
+}
+
+/**
+ * @brief Semaphore wait that resumes after signals.
+ */
+static void semWait(sem_t *sem) {
+    while (sem_wait(sem) == -1 && errno == EINTR) {
+    }
+}
+
+/**
+ * @brief Appends points to a worker's ring, blocking only while it is full.
+ * @param set Ring set.
+ * @param ring Ring of the calling worker.
+ * @param points Points to append.
+ * @param count Number of points.
+ * @return true (the parent always drains the rings).
+ */
+bool ringPush(RingSet *set, PointRing *ring, const Point *points, int count) {
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    for (int written = 0; written < count;) {
+        unsigned long used = head - atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (used == RING_CAPACITY) {
+            atomic_store(&ring->head, head);
+            wakeConsumer(set);
+
+            // Cheio: anunciar a espera e voltar a verificar antes de bloquear
+            atomic_store(&ring->producerWaiting, 1);
+            if (head - atomic_load(&ring->tail) == RING_CAPACITY) semWait(&ring->space);
+            atomic_store(&ring->producerWaiting, 0);
+            continue;
+        }
+
+        int n = RING_CAPACITY - used < (unsigned long)(count - written) ? (int)(RING_CAPACITY - used) : count - written;
+        for (int k = 0; k < n; k++) ring->slots[(head + k) & RING_MASK] = points[written + k];
+        head += n;
+        written += n;
+    }
+
+    atomic_store(&ring->head, head);
+    wakeConsumer(set);
+    return true;
+}
+
+/**
+ * @brief Marks a worker's ring as complete; its counter must already be final.
+ */
+void ringFinish(RingSet *set, PointRing *ring) {
+    atomic_store(&ring->finished, 1);
+    wakeConsumer(set);
+}
+
+/**
+ * @brief Takes up to max points from a ring without blocking.
+ * @param ring Ring to drain.
+ * @param out Output array of at least max points.
+ * @param max Capacity of out.
+ * @return Number of points taken.
+ */
+int ringPop(PointRing *ring, Point *out, int max) {
+    unsigned long tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned long available = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    int n = available < (unsigned long)max ? (int)available : max;
+    if (n == 0) return 0;
+
+    for (int k = 0; k < n; k++) out[k] = ring->slots[(tail + k) & RING_MASK];
+    atomic_store(&ring->tail, tail + n);
+
+    if (atomic_load(&ring->producerWaiting) && atomic_exchange(&ring->producerWaiting, 0)) {
+        sem_post(&ring->space);
+    }
+    return n;
+}
+
+/**
+ * @brief Parent side: sleeps until a worker publishes, unless something is
+ * already pending, or until the timeout. A finished ring counts as pending
+ * until the parent sets its finishedSeen.
+ * @param set Ring set.
+ * @param timeoutMs Longest sleep, in milliseconds.
+ * @return false if the timeout expired.
+ */
+bool ringSetWait(RingSet *set, int timeoutMs) {
+    atomic_store(&set->consumerWaiting, 1);
+    for (int i = 0; i < set->workers; i++) {
+        PointRing *ring = &set->rings[i];
+        if (atomic_load(&ring->head) != atomic_load(&ring->tail) ||
+            (atomic_load(&ring->finished) && !ring->finishedSeen)) {
+            atomic_store(&set->consumerWaiting, 0);
+            return true;
+        }
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += (long)timeoutMs * 1000000;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+
+    int rc;
+    while ((rc = sem_timedwait(&set->dataReady, &deadline)) == -1 && errno == EINTR) {
+    }
+    atomic_store(&set->consumerWaiting, 0);
+    return rc == 0;
+}
@@ -0,0 +1,53 @@
+#ifndef MC_RING_H
+#define MC_RING_H
+
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "mc_geometry.h"
+#include "mc_progress.h"
+
+#define RING_CAPACITY 16384  // points per worker, a power of two
+#define RING_MASK (RING_CAPACITY - 1)
+
+/*
+ * Single-producer/single-consumer rings in POSIX shared memory, one per
+ * forked worker, carrying the points inside the polygon to the parent.
+ *
+ * head is written only by the worker and tail only by the parent, each on
+ * its own cache line, and both run free: a worker publishes a whole batch
+ * with one release store and the parent drains everything available with
+ * one acquire load. Neither side makes a system call while the ring has
+ * room and data. A worker blocks on its ring's semaphore only when the
+ * ring is full, and the parent sleeps on the set's semaphore only when
+ * every ring is empty; a waiter announces itself in a flag that the other
+ * side checks after publishing, so wake-ups cost nothing in the common case.
+ */
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_ulong head;  // points written, worker-owned
+    _Alignas(CACHE_LINE) atomic_ulong tail;  // points read, parent-owned
+    bool finishedSeen;                       // parent-owned
+    _Alignas(CACHE_LINE) atomic_int producerWaiting;
+    atomic_int finished;
+    sem_t space;
+    WorkerCounter counter;                   // samples and hits so far
+    Point slots[RING_CAPACITY];
+} PointRing;
+
+typedef struct {
+    _Alignas(CACHE_LINE) atomic_int consumerWaiting;
+    sem_t dataReady;
+    int workers;
+    size_t size;
+    PointRing rings[];
+} RingSet;
+
+RingSet *createRingSet(int workers);
+void destroyRingSet(RingSet *set);
+bool ringPush(RingSet *set, PointRing *ring, const Point *points, int count);
+void ringFinish(RingSet *set, PointRing *ring);
+int ringPop(PointRing *ring, Point *out, int max);
+bool ringSetWait(RingSet *set, int timeoutMs);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mc_options.h"
+#include "mc_rng.h"
+
+/**
+ * @brief SplitMix64 step, used to expand a 64-bit seed into the full state.
+ */
+static uint64_t splitMix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Initializes a generator from a 64-bit seed.
+ * @param rng Generator to initialize.
+ * @param seed Any value; equal seeds give equal streams.
+ */
+void rngSeed(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) rng->s[i] = splitMix64(&seed);
+}
+
+/**
+ * @brief Advances the generator by 2^128 steps.
+ * @param rng Generator state.
+ */
+void rngJump(Rng *rng) {
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t s[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                for (int k = 0; k < 4; k++) s[k] ^= rng->s[k];
+            }
+            rngNext(rng);
+        }
+    }
+
+    memcpy(rng->s, s, sizeof(s));
+}
+
+/**
+ * @brief Initializes the independent stream of one worker.
+ * @param rng Generator to initialize.
+ * @param seed Seed shared by every worker of the run.
+ * @param stream Worker number (0, 1, 2, ...).
+ */
+void rngStream(Rng *rng, uint64_t seed, int stream) {
+    rngSeed(rng, seed);
+    for (int i = 0; i < stream; i++) rngJump(rng);
+}
+
+/**
+ * @brief Initializes the generator of one chunk of samples.
+ * @param rng Generator to initialize.
+ * @param seed Seed shared by every chunk of the run.
+ * @param substream Chunk number.
+ */
+void rngSubstream(Rng *rng, uint64_t seed, uint64_t substream) {
+    uint64_t mixed = seed;
+    uint64_t key = splitMix64(&mixed) ^ substream;
+    rngSeed(rng, splitMix64(&key));
+}
+
+/**
+ * @brief Fills an array with uniform doubles in [lo, hi).
+ * @param rng Generator state.
+ * @param out Array to fill.
+ * @param count Number of values.
+ * @param lo Lower bound.
+ * @param hi Upper bound.
+ */
+void rngFillUniform(Rng *rng, double *out, int count, double lo, double hi) {
+    double scale = hi - lo;
+    for (int i = 0; i < count; i++) out[i] = lo + rngDouble(rng) * scale;
+}
+
+/**
+ * @brief Extracts an optional "--seed <n>" pair from the command line.
+ *
+ * The pair is removed from argv so the positional arguments keep their
+ * usual positions. Without it the seed is derived from the clock and pid.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param seed Output: the seed to use.
+ * @return false if --seed is present without a valid number.
+ */
+bool takeSeedOption(int *argc, char *argv[], uint64_t *seed) {
+    const char *text;
+    char *end;
+
+    *seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+    if (!takeOption(argc, argv, "--seed", &text)) return true;
+    if (text == NULL || *text == '\0') return false;
+
+    *seed = strtoull(text, &end, 10);
+    return *end == '\0';
+}
@@ -0,0 +1,62 @@
+#ifndef MC_RNG_H
+#define MC_RNG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * xoshiro256** pseudo-random generator (Blackman & Vigna).
+ *
+ * Every worker owns its own Rng, so there is no shared hidden state as with
+ * rand(). Workers derive independent streams from one seed: stream k is the
+ * seeded state advanced by k jumps of 2^128 steps, which can never overlap
+ * for any realistic run length and is reproducible for a given --seed.
+ *
+ * When work is scheduled dynamically (work stealing), each chunk of samples
+ * gets its own substream instead, seeded from (seed, chunk number), so the
+ * result of a run does not depend on which thread ran which chunk.
+ */
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+void rngSeed(Rng *rng, uint64_t seed);
+void rngJump(Rng *rng);
+void rngStream(Rng *rng, uint64_t seed, int stream);
+void rngSubstream(Rng *rng, uint64_t seed, uint64_t substream);
+void rngFillUniform(Rng *rng, double *out, int count, double lo, double hi);
+bool takeSeedOption(int *argc, char *argv[], uint64_t *seed);
+
+static inline uint64_t rotl64(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Returns the next 64 random bits of the stream.
+ * @param rng Generator state.
+ * @return Uniformly distributed 64-bit value.
+ */
+static inline uint64_t rngNext(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @brief Returns a uniformly distributed double in [0, 1) with 53 random bits.
+ * @param rng Generator state.
+ */
+static inline double rngDouble(Rng *rng) {
+    return (rngNext(rng) >> 11) * 0x1.0p-53;
+}
+
+#endif
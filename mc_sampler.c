@@ -0,0 +1,180 @@
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+#include "mc_options.h"
+#include "mc_sampler.h"
+
+static const char *SAMPLER_NAMES[] = {"uniform", "stratified", "halton", "sobol"};
+
+static uint64_t sobolDirectionX[64];
+static uint64_t sobolDirectionY[64];
+static pthread_once_t sobolOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Fills the direction numbers of the first two Sobol' dimensions.
+ *
+ * Dimension 1 is the van der Corput sequence; dimension 2 uses the
+ * primitive polynomial x + 1 with m_1 = 1.
+ */
+static void initSobolDirections(void) {
+    uint64_t v = 1ULL << 63;
+    for (int k = 0; k < 64; k++) {
+        sobolDirectionX[k] = 1ULL << (63 - k);
+        sobolDirectionY[k] = v;
+        v ^= v >> 1;
+    }
+}
+
+/**
+ * @brief Sobol' point of Gray-code rank n: XOR of the directions of gray(n).
+ */
+static void sobolPoint(uint64_t n, uint64_t *x, uint64_t *y) {
+    uint64_t gray = n ^ (n >> 1);
+    *x = *y = 0;
+    for (int k = 0; gray != 0; k++, gray >>= 1) {
+        if (gray & 1) {
+            *x ^= sobolDirectionX[k];
+            *y ^= sobolDirectionY[k];
+        }
+    }
+}
+
+static double radicalInverse2(uint64_t n) {
+    n = ((n >> 1) & 0x5555555555555555ULL) | ((n & 0x5555555555555555ULL) << 1);
+    n = ((n >> 2) & 0x3333333333333333ULL) | ((n & 0x3333333333333333ULL) << 2);
+    n = ((n >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((n & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    n = __builtin_bswap64(n);
+    return (n >> 11) * 0x1.0p-53;
+}
+
+static double radicalInverse3(uint64_t n) {
+    double inverse = 0, scale = 1.0 / 3;
+    for (; n != 0; n /= 3, scale /= 3) inverse += (n % 3) * scale;
+    return inverse;
+}
+
+/**
+ * @brief Adds the shared random shift to a unit coordinate, modulo 1.
+ */
+static inline double rotate(double u, double shift) {
+    u += shift;
+    return u >= 1 ? u - 1 : u;
+}
+
+/**
+ * @brief Prepares a sampler to produce points [first, first + count) of the run.
+ * @param sampler Sampler to initialize.
+ * @param kind Point generator.
+ * @param domain Rectangle the points are drawn from.
+ * @param rng The worker's generator (uniform points and stratified jitter).
+ * @param seed Seed of the run; selects the shared quasi-random shift.
+ * @param first Global index of the worker's first point.
+ * @param total Number of points of the whole run, across all workers.
+ */
+void initSampler(Sampler *sampler, SamplerKind kind, BoundingBox domain, const Rng *rng,
+                 uint64_t seed, uint64_t first, uint64_t total) {
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->kind = kind;
+    sampler->domain = domain;
+    sampler->rng = *rng;
+    sampler->index = first;
+    sampler->total = total;
+
+    sampler->strataSide = (uint64_t)sqrt((double)total);
+    while (sampler->strataSide * sampler->strataSide > total) sampler->strataSide--;
+    uint64_t strata = sampler->strataSide * sampler->strataSide;
+    sampler->stratifiedEnd = strata > 0 ? total / strata * strata : 0;
+
+    // Mesmo deslocamento para todos os trabalhadores: depende só da semente
+    Rng shift;
+    rngSeed(&shift, seed);
+    sampler->shiftX = rngDouble(&shift);
+    sampler->shiftY = rngDouble(&shift);
+
+    if (kind == SAMPLER_SOBOL) {
+        pthread_once(&sobolOnce, initSobolDirections);
+        sobolPoint(first, &sampler->sobolX, &sampler->sobolY);
+    }
+}
+
+/**
+ * @brief Produces the next count points of the sampler's slice.
+ * @param sampler Sampler initialized by initSampler().
+ * @param xs Output x coordinates.
+ * @param ys Output y coordinates.
+ * @param count Number of points.
+ */
+void samplerFill(Sampler *sampler, double *xs, double *ys, int count) {
+    BoundingBox *d = &sampler->domain;
+    double width = d->maxX - d->minX, height = d->maxY - d->minY;
+
+    switch (sampler->kind) {
+        case SAMPLER_UNIFORM:
+            rngFillUniform(&sampler->rng, xs, count, d->minX, d->maxX);
+            rngFillUniform(&sampler->rng, ys, count, d->minY, d->maxY);
+            break;
+
+        case SAMPLER_STRATIFIED: {
+            uint64_t side = sampler->strataSide;
+            for (int i = 0; i < count; i++, sampler->index++) {
+                double u = rngDouble(&sampler->rng), v = rngDouble(&sampler->rng);
+                if (sampler->index < sampler->stratifiedEnd) {
+                    uint64_t stratum = sampler->index % (side * side);
+                    u = (stratum % side + u) / side;
+                    v = (stratum / side + v) / side;
+                }
+                xs[i] = d->minX + u * width;
+                ys[i] = d->minY + v * height;
+            }
+            break;
+        }
+
+        case SAMPLER_HALTON:
+            for (int i = 0; i < count; i++, sampler->index++) {
+                xs[i] = d->minX + rotate(radicalInverse2(sampler->index), sampler->shiftX) * width;
+                ys[i] = d->minY + rotate(radicalInverse3(sampler->index), sampler->shiftY) * height;
+            }
+            break;
+
+        case SAMPLER_SOBOL:
+            for (int i = 0; i < count; i++) {
+                xs[i] = d->minX + rotate((sampler->sobolX >> 11) * 0x1.0p-53, sampler->shiftX) * width;
+                ys[i] = d->minY + rotate((sampler->sobolY >> 11) * 0x1.0p-53, sampler->shiftY) * height;
+                // Ordem de Gray: o ponto seguinte difere numa só direção
+                int k = __builtin_ctzll(++sampler->index);
+                sampler->sobolX ^= sobolDirectionX[k];
+                sampler->sobolY ^= sobolDirectionY[k];
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Extracts an optional "--sampler <name>" from the command line.
+ * @param argc Argument count, updated when the option is removed.
+ * @param argv Argument vector, updated when the option is removed.
+ * @param kind Output: the sampler; SAMPLER_UNIFORM when absent.
+ * @return false if the name is missing or unknown.
+ */
+bool takeSamplerOption(int *argc, char *argv[], SamplerKind *kind) {
+    const char *name;
+
+    *kind = SAMPLER_UNIFORM;
+    if (!takeOption(argc, argv, "--sampler", &name)) return true;
+    if (name == NULL) return false;
+
+    for (int k = 0; k < (int)(sizeof(SAMPLER_NAMES) / sizeof(SAMPLER_NAMES[0])); k++) {
+        if (strcmp(name, SAMPLER_NAMES[k]) == 0) {
+            *kind = (SamplerKind)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the command-line name of a sampler.
+ */
+const char *samplerName(SamplerKind kind) {
+    return SAMPLER_NAMES[kind];
+}
@@ -0,0 +1,52 @@
+#ifndef MC_SAMPLER_H
+#define MC_SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mc_geometry.h"
+#include "mc_rng.h"
+
+typedef enum {
+    SAMPLER_UNIFORM,
+    SAMPLER_STRATIFIED,
+    SAMPLER_HALTON,
+    SAMPLER_SOBOL
+} SamplerKind;
+
+/*
+ * Point generators over a rectangular domain.
+ *
+ * Every sampler sees the run as one global sequence of `total` points and
+ * produces the slice [first, first + count) of it, so workers given
+ * disjoint index ranges never produce the same point:
+ *  - uniform: i.i.d. points from the worker's Rng;
+ *  - stratified: the domain is cut into S x S strata (S = floor(sqrt(total)))
+ *    and point i is jittered inside stratum i mod S^2; the last
+ *    total mod S^2 points are uniform, so every stratum gets the same count;
+ *  - halton: radical inverses in bases 2 and 3;
+ *  - sobol: the first two Sobol' dimensions in Gray-code order.
+ * The quasi-random sequences get one random shift modulo 1, derived from
+ * the seed and shared by all workers (Cranley-Patterson rotation), so runs
+ * with different seeds are independent and the estimate stays unbiased.
+ */
+typedef struct {
+    SamplerKind kind;
+    BoundingBox domain;
+    Rng rng;
+    uint64_t index;
+    uint64_t total;
+    uint64_t strataSide;
+    uint64_t stratifiedEnd;
+    double shiftX;
+    double shiftY;
+    uint64_t sobolX;
+    uint64_t sobolY;
+} Sampler;
+
+void initSampler(Sampler *sampler, SamplerKind kind, BoundingBox domain, const Rng *rng,
+                 uint64_t seed, uint64_t first, uint64_t total);
+void samplerFill(Sampler *sampler, double *xs, double *ys, int count);
+bool takeSamplerOption(int *argc, char *argv[], SamplerKind *kind);
+const char *samplerName(SamplerKind kind);
+
+#endif
@@ -0,0 +1,180 @@
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mc_slab.h"
+
+/**
+ * @brief Returns the vertex after i in its ring, wrapping to the ring's start.
+ */
+static inline int nextInRing(const int ringStart[], int ring, int i) {
+    return i + 1 < ringStart[ring + 1] ? i + 1 : ringStart[ring];
+}
+
+/**
+ * @brief Builds the slab index of a set of rings. Done once, before sampling.
+ * @param points[] Vertices of all rings, ring after ring.
+ * @param ringStart[] Ring r is points[ringStart[r] .. ringStart[r + 1]).
+ * @param numRings Number of rings.
+ * @param ringRegion[] Region of each ring, or NULL for a single region.
+ * @param index Index to fill; release it with freeSlabIndex().
+ * @return true on success, false for fewer than 3 vertices, a flat shape,
+ * more edge entries than an int can number or if memory could not be allocated.
+ */
+bool buildSlabIndex(const Point points[], const int ringStart[], int numRings, const int ringRegion[],
+                    SlabIndex *index) {
+    memset(index, 0, sizeof(*index));
+    int n = ringStart[numRings];
+    if (n < 3) return false;
+
+    double minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < n; i++) {
+        if (points[i].y < minY) minY = points[i].y;
+        if (points[i].y > maxY) maxY = points[i].y;
+    }
+    if (maxY <= minY) return false;
+
+    index->minY = minY;
+    index->maxY = maxY;
+    index->numSlabs = n;
+    index->slabsPerUnit = index->numSlabs / (maxY - minY);
+    index->slabStart = calloc(index->numSlabs + 1, sizeof(int));
+    if (index->slabStart == NULL) return false;
+
+    // Primeira passagem: contar as arestas de cada faixa
+    for (int r = 0; r < numRings; r++) {
+        for (int i = ringStart[r]; i < ringStart[r + 1]; i++) {
+            Point a = points[i], b = points[nextInRing(ringStart, r, i)];
+            if (a.y == b.y) continue;
+            double yLo = a.y < b.y ? a.y : b.y;
+            double yHi = a.y < b.y ? b.y : a.y;
+            int first = slabOf(index, yLo), last = slabOf(index, yHi);
+            for (int s = first; s <= last; s++) index->slabStart[s + 1]++;
+        }
+    }
+    // Totais em long: com muitas arestas longas a soma passa de INT_MAX
+    long total = 0;
+    for (int s = 0; s < index->numSlabs; s++) {
+        total += ((long)index->slabStart[s + 1] + SLAB_LANES - 1) / SLAB_LANES * SLAB_LANES;
+        if (total > INT_MAX) {
+            fprintf(stderr, "The slab index would need more than %d edge entries\n", INT_MAX);
+            freeSlabIndex(index);
+            return false;
+        }
+        index->slabStart[s + 1] = (int)total;
+    }
+    size_t entries = index->slabStart[index->numSlabs];
+
+    index->edgeYLo = malloc(entries * sizeof(double));
+    index->edgeYHi = malloc(entries * sizeof(double));
+    index->edgeX = malloc(entries * sizeof(double));
+    index->edgeSlope = malloc(entries * sizeof(double));
+    if (ringRegion != NULL) index->edgeRegion = calloc(entries, sizeof(int));
+    int *fill = malloc(index->numSlabs * sizeof(int));
+    if (!index->edgeYLo || !index->edgeYHi || !index->edgeX || !index->edgeSlope || !fill ||
+        (ringRegion != NULL && !index->edgeRegion)) {
+        free(fill);
+        freeSlabIndex(index);
+        return false;
+    }
+    memcpy(fill, index->slabStart, index->numSlabs * sizeof(int));
+    for (size_t e = 0; e < entries; e++) {
+        index->edgeYLo[e] = INFINITY;
+        index->edgeYHi[e] = -INFINITY;
+        index->edgeX[e] = 0;
+        index->edgeSlope[e] = 0;
+    }
+
+    // Segunda passagem: copiar cada aresta para as faixas que atravessa
+    for (int r = 0; r < numRings; r++) {
+        for (int i = ringStart[r]; i < ringStart[r + 1]; i++) {
+            Point a = points[i], b = points[nextInRing(ringStart, r, i)];
+            if (a.y == b.y) continue;
+            Point lo = a.y < b.y ? a : b;
+            Point hi = a.y < b.y ? b : a;
+            double slope = (hi.x - lo.x) / (hi.y - lo.y);
+            int first = slabOf(index, lo.y), last = slabOf(index, hi.y);
+            for (int s = first; s <= last; s++) {
+                int e = fill[s]++;
+                index->edgeYLo[e] = lo.y;
+                index->edgeYHi[e] = hi.y;
+                index->edgeX[e] = lo.x;
+                index->edgeSlope[e] = slope;
+                if (index->edgeRegion) index->edgeRegion[e] = ringRegion[r];
+            }
+        }
+    }
+
+    free(fill);
+    return true;
+}
+
+/**
+ * @brief Checks if a point is inside the indexed polygon (crossing number).
+ *
+ * Casts a ray towards +x and counts the edges of the point's slab that
+ * cross it. Edges are half-open in y so shared vertices are counted once.
+ * @param index Slab index built by buildSlabIndex().
+ * @param p Point to check.
+ * @return true if the point p is inside the polygon, else false.
+ */
+bool isInsideSlabIndex(const SlabIndex *index, Point p) {
+    if (p.y < index->minY || p.y >= index->maxY) return false;
+
+    int s = slabOf(index, p.y);
+    bool inside = false;
+    for (int e = index->slabStart[s]; e < index->slabStart[s + 1]; e++) {
+        if (p.y >= index->edgeYLo[e] && p.y < index->edgeYHi[e] &&
+            p.x < index->edgeX[e] + (p.y - index->edgeYLo[e]) * index->edgeSlope[e]) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/**
+ * @brief Finds every region whose rings enclose a point, in one pass over
+ * the edges of the point's slab with one crossing parity per region.
+ * @param index Slab index built with ringRegion.
+ * @param p Point to check.
+ * @param parity Scratch array of one zeroed byte per region; left zeroed.
+ * @param regions Output: the regions holding p (room for one per region).
+ * @return Number of regions holding p.
+ */
+int regionsAtPoint(const SlabIndex *index, Point p, unsigned char *parity, int *regions) {
+    if (p.y < index->minY || p.y >= index->maxY) return 0;
+
+    // regions serve primeiro de lista das regiões tocadas; o bit 2 de parity marca-as
+    int s = slabOf(index, p.y), touched = 0;
+    for (int e = index->slabStart[s]; e < index->slabStart[s + 1]; e++) {
+        if (p.y >= index->edgeYLo[e] && p.y < index->edgeYHi[e] &&
+            p.x < index->edgeX[e] + (p.y - index->edgeYLo[e]) * index->edgeSlope[e]) {
+            int r = index->edgeRegion[e];
+            if (!(parity[r] & 2)) regions[touched++] = r;
+            parity[r] = (parity[r] | 2) ^ 1;
+        }
+    }
+
+    int count = 0;
+    for (int k = 0; k < touched; k++) {
+        int r = regions[k];
+        if (parity[r] & 1) regions[count++] = r;
+        parity[r] = 0;
+    }
+    return count;
+}
+
+/**
+ * @brief Releases the memory held by a slab index.
+ * @param index Index to release.
+ */
+void freeSlabIndex(SlabIndex *index) {
+    free(index->slabStart);
+    free(index->edgeYLo);
+    free(index->edgeYHi);
+    free(index->edgeX);
+    free(index->edgeSlope);
+    free(index->edgeRegion);
+    memset(index, 0, sizeof(*index));
+}
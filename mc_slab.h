@@ -0,0 +1,62 @@
+#ifndef MC_SLAB_H
+#define MC_SLAB_H
+
+#include <stdbool.h>
+#include "mc_geometry.h"
+
+#define SLAB_LANES 4
+
+/*
+ * Horizontal slab index over the edges of a polygon.
+ *
+ * The y-range of the polygon is cut into equal-height slabs and every
+ * non-horizontal edge is copied into each slab its y-interval overlaps.
+ * A ray cast from a point only visits the edges of the slab holding the
+ * point's y, so the cost of a query depends on how many edges cross one
+ * slab and not on the total vertex count.
+ *
+ * Edges are stored per slab in contiguous SoA arrays (CSR layout):
+ * slab s owns entries [slabStart[s], slabStart[s + 1]). Each slab is padded
+ * to a multiple of SLAB_LANES with sentinel entries that never cross any
+ * ray, so vector kernels can load whole groups of edges without a tail loop.
+ *
+ * The edges may come from several closed rings (outer boundaries, holes,
+ * separate parts). A point is inside where the crossing count is odd, so
+ * holes need no special case. When the rings belong to several regions,
+ * edgeRegion tags every entry with its region and regionsAtPoint() keeps
+ * one parity per region, so all regions are tested in the same pass over
+ * the slab.
+ */
+typedef struct {
+    double minY;
+    double maxY;
+    double slabsPerUnit;
+    int numSlabs;
+    int *slabStart;
+    double *edgeYLo;
+    double *edgeYHi;
+    double *edgeX;      // x of the edge at edgeYLo
+    double *edgeSlope;  // dx/dy of the edge
+    int *edgeRegion;    // region of the edge, NULL when there is a single region
+} SlabIndex;
+
+bool buildSlabIndex(const Point points[], const int ringStart[], int numRings, const int ringRegion[],
+                    SlabIndex *index);
+bool isInsideSlabIndex(const SlabIndex *index, Point p);
+int regionsAtPoint(const SlabIndex *index, Point p, unsigned char *parity, int *regions);
+void freeSlabIndex(SlabIndex *index);
+
+/**
+ * @brief Maps a y coordinate to the slab that holds it, clamped to the index.
+ * @param index Slab index.
+ * @param y Coordinate to map.
+ * @return Slab number in [0, numSlabs - 1].
+ */
+static inline int slabOf(const SlabIndex *index, double y) {
+    int s = (int)((y - index->minY) * index->slabsPerUnit);
+    if (s < 0) return 0;
+    if (s >= index->numSlabs) return index->numSlabs - 1;
+    return s;
+}
+
+#endif
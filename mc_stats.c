@@ -0,0 +1,105 @@
+#include <math.h>
+#include <stdio.h>
+#include "mc_options.h"
+#include "mc_stats.h"
+
+/**
+ * @brief Extracts --target-se, --target-rel and --confidence from the command line.
+ * @param argc Argument count, updated when options are removed.
+ * @param argv Argument vector, updated when options are removed.
+ * @param rule Output: the stopping rule (inactive when no target is given).
+ * @return false if an option is malformed or out of range.
+ */
+bool takeStopRule(int *argc, char *argv[], StopRule *rule) {
+    rule->targetStdError = 0;
+    rule->targetRelError = 0;
+    rule->confidence = DEFAULT_CONFIDENCE;
+    rule->minSamples = MIN_ADAPTIVE_SAMPLES;
+
+    if (!takeDoubleOption(argc, argv, "--target-se", &rule->targetStdError) ||
+        !takeDoubleOption(argc, argv, "--target-rel", &rule->targetRelError) ||
+        !takeDoubleOption(argc, argv, "--confidence", &rule->confidence)) return false;
+
+    return rule->targetStdError >= 0 && rule->targetRelError >= 0 &&
+           rule->confidence > 0 && rule->confidence < 1;
+}
+
+/**
+ * @brief Tells whether the run should stop on precision instead of running the full budget.
+ */
+bool stopRuleActive(const StopRule *rule) {
+    return rule->targetStdError > 0 || rule->targetRelError > 0;
+}
+
+/**
+ * @brief Standard error of the area estimate.
+ *
+ * Uses p = (h + 1) / (n + 2), so a run that has seen no hits (or only hits)
+ * yet does not report a zero error.
+ * @param domainArea Area of the sampled domain.
+ * @param samples Number of samples n.
+ * @param hits Number of samples inside h.
+ * @return The standard error, in area units.
+ */
+double areaStdError(double domainArea, long samples, long hits) {
+    if (samples <= 0) return INFINITY;
+
+    double p = (hits + 1.0) / (samples + 2.0);
+    return domainArea * sqrt(p * (1 - p) / samples);
+}
+
+/**
+ * @brief Checks whether the samples so far meet the stopping rule.
+ * @param rule Stopping rule.
+ * @param domainArea Area of the sampled domain.
+ * @param knownArea Area counted without sampling.
+ * @param samples Number of samples so far.
+ * @param hits Number of samples inside so far.
+ * @return true if every requested target is met.
+ */
+bool targetReached(const StopRule *rule, double domainArea, double knownArea, long samples, long hits) {
+    if (!stopRuleActive(rule) || samples < rule->minSamples) return false;
+
+    double se = areaStdError(domainArea, samples, hits);
+    if (rule->targetStdError > 0 && se > rule->targetStdError) return false;
+    if (rule->targetRelError > 0) {
+        double estimate = knownArea + domainArea * hits / samples;
+        if (estimate <= 0 || zForConfidence(rule->confidence) * se > rule->targetRelError * estimate) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Two-sided normal quantile: z such that P(|Z| <= z) = confidence.
+ *
+ * Newton's method on erf(z / sqrt(2)) = confidence, started at 0; erf is
+ * concave there, so the iterates increase monotonically to the root.
+ * @param confidence Confidence level in (0, 1).
+ */
+double zForConfidence(double confidence) {
+    double z = 0;
+    for (int i = 0; i < 100; i++) {
+        double f = erf(z / M_SQRT2) - confidence;
+        double step = f / (sqrt(2 / M_PI) * exp(-z * z / 2));
+        z -= step;
+        if (fabs(step) < 1e-12) break;
+    }
+    return z;
+}
+
+/**
+ * @brief Prints the confidence interval of the area estimate.
+ * @param domainArea Area of the sampled domain.
+ * @param knownArea Area counted without sampling.
+ * @param samples Number of samples.
+ * @param hits Number of samples inside.
+ * @param confidence Confidence level of the interval.
+ */
+void printInterval(double domainArea, double knownArea, long samples, long hits, double confidence) {
+    double estimate = knownArea + (samples > 0 ? domainArea * hits / samples : 0);
+    double halfWidth = zForConfidence(confidence) * areaStdError(domainArea, samples, hits);
+
+    printf("%.1f%% confidence interval: [%f, %f] (+/- %f, standard error %f, %ld samples)\n",
+           confidence * 100, estimate - halfWidth, estimate + halfWidth, halfWidth,
+           areaStdError(domainArea, samples, hits), samples);
+}
@@ -0,0 +1,32 @@
+#ifndef MC_STATS_H
+#define MC_STATS_H
+
+#include <stdbool.h>
+
+#define DEFAULT_CONFIDENCE 0.95
+#define MIN_ADAPTIVE_SAMPLES 10000
+
+/*
+ * Adaptive stopping. Each sample is a Bernoulli trial (inside or not), so
+ * after n samples with h hits the area estimate is
+ * knownArea + domainArea * h / n with standard error
+ * domainArea * sqrt(p (1 - p) / n); knownArea, the part of the area
+ * counted without sampling, adds no error. A run with a StopRule
+ * streams batches and stops as soon as the requested precision is reached;
+ * the sample count given on the command line becomes an upper budget.
+ */
+typedef struct {
+    double targetStdError;  // absolute standard error of the area, 0 = off
+    double targetRelError;  // interval half-width / estimate, 0 = off
+    double confidence;      // confidence level of the interval
+    long minSamples;        // never stop before this many samples
+} StopRule;
+
+bool takeStopRule(int *argc, char *argv[], StopRule *rule);
+bool stopRuleActive(const StopRule *rule);
+bool targetReached(const StopRule *rule, double domainArea, double knownArea, long samples, long hits);
+double zForConfidence(double confidence);
+double areaStdError(double domainArea, long samples, long hits);
+void printInterval(double domainArea, double knownArea, long samples, long hits, double confidence);
+
+#endif
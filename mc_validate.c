@@ -0,0 +1,111 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mc_pool.h"
+#include "mc_validate.h"
+
+#define MAX_RUNGS 48
+
+typedef struct {
+    Tally tally;
+    double seconds;
+    double estimate;
+    double relError;
+} Rung;
+
+/**
+ * @brief Seconds elapsed since start, on the monotonic clock.
+ */
+static double secondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Runs the validation ladder over a loaded polygon and prints its table.
+ * @return false if a run failed.
+ */
+static bool validateModel(const PolygonModel *model, const EstimatorConfig *config) {
+    EstimatorConfig rung = *config;
+    Rung rungs[MAX_RUNGS];
+    long budgets[MAX_RUNGS];
+    int count = 0;
+    double domainArea, knownArea;
+
+    samplingAreas(model, config->domain, &domainArea, &knownArea);
+
+    rung.showProgress = false;
+    rung.verbose = false;
+    if (rung.workers <= 0) rung.workers = defaultWorkerCount();
+
+    // Orçamentos N, N/4, N/16, ... até MIN_VALIDATION_POINTS, corridos do menor para o maior
+    for (long b = config->totalPoints; count < MAX_RUNGS; b /= 4) {
+        budgets[count++] = b;
+        if (b / 4 < MIN_VALIDATION_POINTS) break;
+    }
+
+    printf("%12s %10s %14s %14s %12s %10s\n", "samples", "seconds", "samples/s", "estimate", "abs error", "rel error");
+    for (int k = 0; k < count; k++) {
+        Rung *r = &rungs[k];
+        struct timespec start;
+
+        rung.totalPoints = budgets[count - 1 - k];
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (!runEstimator(model, &rung, &r->tally)) return false;
+        r->seconds = secondsSince(&start);
+        r->estimate = knownArea + (r->tally.samples > 0 ? domainArea * r->tally.hits / r->tally.samples : 0);
+        r->relError = fabs(r->estimate - model->exactArea) / model->exactArea;
+
+        printf("%12ld %10.4f %14.0f %14.6f %12.3e %10.3e\n", r->tally.samples, r->seconds,
+               r->seconds > 0 ? r->tally.samples / r->seconds : 0, r->estimate,
+               fabs(r->estimate - model->exactArea), r->relError);
+    }
+
+    int reached = count;
+    while (reached > 0 && rungs[reached - 1].relError <= config->accuracy) reached--;
+    if (reached < count) {
+        printf("Relative error %g reached with %ld samples in %.4f s (%s backend, %d workers, sampler %s, domain %s)\n",
+               config->accuracy, rungs[reached].tally.samples, rungs[reached].seconds,
+               backendName(rung.backend), rung.workers, samplerName(rung.sampler), domainName(rung.domain));
+    } else {
+        printf("Relative error %g not reached within %ld samples\n", config->accuracy, config->totalPoints);
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the --exact or --validate mode of a driver.
+ * @param filename Path of the text or binary polygon file.
+ * @param config Configuration of the run; mode selects what is done.
+ * @return false if the polygon could not be loaded or a run failed.
+ */
+bool runReferenceMode(const char *filename, const EstimatorConfig *config) {
+    PolygonModel model;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!loadPolygonModel(filename, &model)) return false;
+    double loadSeconds = secondsSince(&start);
+
+    printf("Exact area of the polygon: %f\n", model.exactArea);
+    printf("Shoelace formula over %d vertices, polygon loaded in %.4f s\n", model.numPoints, loadSeconds);
+    if (model.numRegions > 1) {
+        // A soma só é a área da união se as regiões não se sobrepuserem
+        printf("Sum of %d regions; it is the area of their union only if they do not overlap\n", model.numRegions);
+    }
+
+    bool ok = true;
+    if (config->mode == RUN_VALIDATE) {
+        if (model.exactArea > 0) {
+            ok = validateModel(&model, config);
+        } else {
+            fprintf(stderr, "The polygon has no area to compare with\n");
+            ok = false;
+        }
+    }
+
+    freePolygonModel(&model);
+    return ok;
+}
@@ -0,0 +1,27 @@
+#ifndef MC_VALIDATE_H
+#define MC_VALIDATE_H
+
+#include <stdbool.h>
+#include "mc_estimator.h"
+
+#define MIN_VALIDATION_POINTS 10000
+
+/*
+ * Reference modes of the drivers, built on the exact shoelace area that
+ * every polygon model carries.
+ *
+ * --exact prints that area without sampling. --validate runs the configured
+ * backend over a ladder of budgets, each four times the previous one and
+ * ending at the requested number of points, and prints for each rung the
+ * estimate, its absolute and relative error, and the sampling rate. Rungs
+ * share the seed, so with the uniform sampler a smaller rung's points are a
+ * prefix of the larger ones and the ladder follows one run's convergence.
+ * The time-to-accuracy is the time of the smallest rung from which every
+ * larger rung stays within the requested relative error.
+ *
+ * The shoelace area is exact only for simple (non self-intersecting)
+ * polygons.
+ */
+bool runReferenceMode(const char *filename, const EstimatorConfig *config);
+
+#endif
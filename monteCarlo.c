@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mc_daemon.h"
+#include "mc_estimator.h"
+#include "mc_options.h"
+#include "mc_pool.h"
+#include "mc_validate.h"
+
+/**
+ * @brief Seconds elapsed since start, on the monotonic clock.
+ */
+static double secondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Main function: one estimator, any backend.
+ */
+int main(int argc, char *argv[]) {
+    EstimatorConfig config;
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.verbose = takeFlag(&argc, argv, "--verbose");
+    config.showProgress = !takeFlag(&argc, argv, "--quiet");
+
+    const char *daemonSocket = NULL;
+    bool useDaemon = takeOption(&argc, argv, "--daemon", &daemonSocket);
+
+    if (!takeEstimatorOptions(&argc, argv, &config) || !takeBackendOption(&argc, argv, &config.backend) ||
+        argc != 4 || (useDaemon && (daemonSocket == NULL || stopRuleActive(&config.rule) || config.checkpointPath != NULL))) {
+        fprintf(stderr,
+                "Usage: %s <polygon file> <workers, 0 = one per core> <number of points>\n"
+                "       [--backend file|pipe|socket|threads|ring] [--seed <seed>] [--sampler uniform|stratified|halton|sobol]\n"
+                "       [--domain box|cells]\n"
+                "       [--target-se <standard error> | --target-rel <relative error>] [--confidence <level>]\n"
+                "       [--throttle <us per point>] [--verbose] [--quiet] [--daemon <socket path>]\n"
+                "       [--checkpoint <file> [--checkpoint-every <seconds>] [--resume]]\n"
+                "       [--exact | --validate [--accuracy <relative error>]]\n"
+                "--verbose prints every point inside (pipe and ring backends); --quiet hides the progress bar.\n"
+                "With a target (threads backend), <number of points> is the maximum budget.\n"
+                "--daemon sends the job to a running monteCarloDaemon, whose pool replaces <workers> and the backend.\n"
+                "--checkpoint saves the finished chunks every 10 s by default; --resume skips those of the last snapshot.\n"
+                "--exact prints the shoelace area without sampling; --validate compares runs of growing size with it.\n",
+                argv[0]);
+        return 1;
+    }
+    config.workers = atoi(argv[2]);
+    config.totalPoints = atol(argv[3]);
+    if (config.workers <= 0) config.workers = defaultWorkerCount();
+    if (config.mode != RUN_ESTIMATE) return runReferenceMode(argv[1], &config) ? 0 : 1;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Estimate estimate;
+    if (useDaemon ? !submitJob(daemonSocket, argv[1], &config, &estimate, &config.workers)
+                  : !estimateArea(argv[1], &config, &estimate)) {
+        fprintf(stderr, "The estimation failed\n");
+        return 1;
+    }
+
+    printf("Estimated area of the polygon: %f\n", estimate.area);
+    for (int r = 0; r < estimate.numRegions; r++) {
+        printf("  region %d: %f (exact %f)\n", r,
+               estimate.regionKnownArea[r] + estimate.domainArea * estimate.regionHits[r] / estimate.tally.samples,
+               estimate.regionArea[r]);
+    }
+    if (stopRuleActive(&config.rule)) {
+        printInterval(estimate.domainArea, estimate.knownArea, estimate.tally.samples, estimate.tally.hits,
+                      config.rule.confidence);
+    }
+    printf("Backend %s, %d workers, sampler %s, domain %s: %ld samples in %.3f s\n",
+           useDaemon ? "daemon" : backendName(config.backend), config.workers, samplerName(config.sampler),
+           domainName(config.domain), estimate.tally.samples, secondsSince(&start));
+
+    freeEstimate(&estimate);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mc_batchrun.h"
+#include "mc_options.h"
+
+/**
+ * Main function
+ *
+ * Batch estimator: estimates many polygons with one pool of threads and
+ * writes one tab-separated row per polygon.
+ */
+int main(int argc, char *argv[]) {
+    EstimatorConfig config;
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.showProgress = !takeFlag(&argc, argv, "--quiet");
+
+    if (!takeEstimatorOptions(&argc, argv, &config) || config.mode != RUN_ESTIMATE || config.checkpointPath != NULL || argc < 5) {
+        fprintf(stderr,
+                "Usage: %s <output table> <threads, 0 = one per core> <points per polygon> <polygon|directory|'glob'|@list>...\n"
+                "       [--seed <seed>] [--sampler uniform|stratified|halton|sobol] [--domain box|cells]\n"
+                "       [--target-se <standard error> | --target-rel <relative error>] [--confidence <level>] [--quiet]\n"
+                "With a target, <points per polygon> is the maximum budget of each polygon.\n", argv[0]);
+        return 1;
+    }
+    config.workers = atoi(argv[2]);
+    config.totalPoints = atol(argv[3]);
+    if (config.totalPoints <= 0) {
+        fprintf(stderr, "The number of points must be positive\n");
+        return 1;
+    }
+
+    char **paths;
+    int count;
+    if (!collectPolygonPaths(argc - 4, argv + 4, &paths, &count)) return 1;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool ok = runPolygonBatch(paths, count, &config, argv[1]);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (ok) {
+        printf("%d polygons estimated in %.3f s, results in %s\n", count,
+               (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, argv[1]);
+    }
+    freePolygonPaths(paths, count);
+    return ok ? 0 : 1;
+}
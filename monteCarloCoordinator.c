@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mc_cluster.h"
+#include "mc_estimator.h"
+#include "mc_options.h"
+
+/**
+ * @brief Seconds elapsed since start, on the monotonic clock.
+ */
+static double secondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Main function
+ *
+ * Coordinator of a distributed estimation: hands out the chunks of one run
+ * to the monteCarloWorker processes that connect to its TCP port, on any
+ * host, and reassigns the chunks of the workers it loses.
+ */
+int main(int argc, char *argv[]) {
+    EstimatorConfig config;
+    initEstimatorConfig(&config, BACKEND_THREADS);
+    config.showProgress = !takeFlag(&argc, argv, "--quiet");
+    double workerTimeout = DEFAULT_WORKER_TIMEOUT;
+
+    if (!takeEstimatorOptions(&argc, argv, &config) || config.mode != RUN_ESTIMATE ||
+        !takeDoubleOption(&argc, argv, "--worker-timeout", &workerTimeout) || workerTimeout <= 0 || argc != 4) {
+        fprintf(stderr,
+                "Usage: %s <port> <polygon file> <number of points>\n"
+                "       [--seed <seed>] [--sampler uniform|stratified|halton|sobol] [--domain box|cells]\n"
+                "       [--target-se <standard error> | --target-rel <relative error>] [--confidence <level>]\n"
+                "       [--throttle <us per point>] [--checkpoint <file> [--checkpoint-every <seconds>] [--resume]]\n"
+                "       [--worker-timeout <seconds>] [--quiet]\n"
+                "Start workers with: monteCarloWorker <this host> <port> <threads>\n"
+                "A worker holding chunks and silent for --worker-timeout seconds (default 30) is presumed dead.\n",
+                argv[0]);
+        return 1;
+    }
+    config.totalPoints = atol(argv[3]);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Estimate estimate;
+    int workers;
+    if (!runCoordinator(argv[1], argv[2], &config, workerTimeout, &estimate, &workers)) {
+        fprintf(stderr, "The estimation failed\n");
+        return 1;
+    }
+
+    printf("Estimated area of the polygon: %f\n", estimate.area);
+    if (stopRuleActive(&config.rule)) {
+        printInterval(estimate.domainArea, estimate.knownArea, estimate.tally.samples, estimate.tally.hits,
+                      config.rule.confidence);
+    }
+    printf("Coordinator, %d workers, sampler %s, domain %s: %ld samples in %.3f s\n", workers,
+           samplerName(config.sampler), domainName(config.domain), estimate.tally.samples, secondsSince(&start));
+    return 0;
+}
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mc_daemon.h"
+
+/**
+ * Main function
+ *
+ * Estimation daemon: keeps a pool of forked workers and their loaded
+ * polygons warm, and serves jobs sent with "monteCarlo --daemon <socket>"
+ * until it receives SIGINT or SIGTERM.
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <socket path> <workers, 0 = one per core>\n", argv[0]);
+        return 1;
+    }
+
+    return runDaemon(argv[1], atoi(argv[2])) ? 0 : 1;
+}
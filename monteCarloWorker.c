@@ -0,0 +1,22 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "mc_cluster.h"
+#include "mc_options.h"
+
+/**
+ * Main function
+ *
+ * Worker of distributed estimations: connects to a monteCarloCoordinator,
+ * samples the chunks it is given with a pool of threads and, unless --once
+ * is given, waits for the next coordinator when the job ends.
+ */
+int main(int argc, char *argv[]) {
+    bool once = takeFlag(&argc, argv, "--once");
+
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s <coordinator host> <port> <threads, 0 = one per core> [--once]\n", argv[0]);
+        return 1;
+    }
+
+    return runClusterWorker(argv[1], argv[2], atoi(argv[3]), once) ? 0 : 1;
+}